@@ -0,0 +1,54 @@
+#include "cell_list.hpp"
+#include <algorithm>
+#include <cmath>
+
+CellList::CellList(float width, float height, float cutoff)
+    : cutoff(cutoff) {
+    // Use as many cells as fit while keeping each side >= cutoff
+    cellsX = std::max(1, static_cast<int>(std::floor(width / cutoff)));
+    cellsY = std::max(1, static_cast<int>(std::floor(height / cutoff)));
+    cellSize = std::max(width / cellsX, height / cellsY);
+    cellStart.assign(cellsX * cellsY + 1, 0);
+}
+
+int CellList::cellCoord(float v, int cells) const {
+    // Particles sitting on (or pushed past) the walls go to the border cells
+    int c = static_cast<int>(v / cellSize);
+    return std::min(cells - 1, std::max(0, c));
+}
+
+int CellList::cellIndex(float x, float y) const {
+    return cellCoord(y, cellsY) * cellsX + cellCoord(x, cellsX);
+}
+
+void CellList::build(const float* x, const float* y, int count) {
+    particleCell.resize(count);
+    for (int i = 0; i < count; ++i) {
+        particleCell[i] = cellIndex(x[i], y[i]);
+    }
+    sortByCell();
+
+    cellX.resize(count);
+    cellY.resize(count);
+    for (int k = 0; k < count; ++k) {
+        cellX[k] = x[cellParticles[k]];
+        cellY[k] = y[cellParticles[k]];
+    }
+}
+
+void CellList::sortByCell() {
+    // Counting sort of the particles by cell index
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+    for (int cell : particleCell) {
+        cellStart[cell + 1]++;
+    }
+    for (std::size_t c = 1; c < cellStart.size(); ++c) {
+        cellStart[c] += cellStart[c - 1];
+    }
+
+    cellParticles.resize(particleCell.size());
+    cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+    for (std::size_t i = 0; i < particleCell.size(); ++i) {
+        cellParticles[cellFill[particleCell[i]]++] = static_cast<int>(i);
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef CELL_LIST_HPP
+#define CELL_LIST_HPP
+#include <vector>
+#include "particle_store.hpp"
+
+// Uniform grid (cell list) for neighbor search between particles.
+//
+// The box [0, width] x [0, height] is split into square cells whose side is at
+// least the interaction cutoff, so every neighbor of a particle closer than the
+// cutoff lies in the 3x3 block of cells around it. The list is rebuilt once per
+// step with a counting sort, which costs O(N) and allocates nothing once the
+// buffers have grown to the particle count. The coordinates are also copied in
+// cell order, so the neighbors of a particle sit in a few contiguous runs.
+class CellList {
+public:
+    CellList(float width, float height, float cutoff);
+
+    // Sort the particles into cells; ParticleT only needs a `position` member
+    template <typename ParticleT>
+    void build(const std::vector<ParticleT>& particles) {
+        coordX.resize(particles.size());
+        coordY.resize(particles.size());
+        for (std::size_t i = 0; i < particles.size(); ++i) {
+            coordX[i] = particles[i].position.x;
+            coordY[i] = particles[i].position.y;
+        }
+        build(coordX.data(), coordY.data(), static_cast<int>(particles.size()));
+    }
+
+    // Same for positions stored as separate coordinate arrays
+    void build(const float* x, const float* y, int count);
+
+    // Call f(j) for every particle j in the cells around (x, y).
+    // Candidates may still be further away than the cutoff, the caller has to check the distance.
+    template <typename F>
+    void forEachNeighbor(float x, float y, F&& f) const {
+        forEachNeighborRange(x, y, [&](int begin, int end) {
+            for (int k = begin; k < end; ++k) {
+                f(cellParticles[k]);
+            }
+        });
+    }
+
+    // Call f(begin, end) for every contiguous run of neighbor candidates around (x, y).
+    // The runs index sortedX()/sortedY() and sortedIndex(), which hold the particles in cell order.
+    template <typename F>
+    void forEachNeighborRange(float x, float y, F&& f) const {
+        int cx = cellCoord(x, cellsX);
+        int cy = cellCoord(y, cellsY);
+        int yBegin = cy > 0 ? cy - 1 : 0;
+        int yEnd = cy < cellsY - 1 ? cy + 1 : cellsY - 1;
+        int xBegin = cx > 0 ? cx - 1 : 0;
+        int xEnd = cx < cellsX - 1 ? cx + 1 : cellsX - 1;
+
+        for (int ny = yBegin; ny <= yEnd; ++ny) {
+            // The cells of one row are contiguous
+            int begin = cellStart[ny * cellsX + xBegin];
+            int end = cellStart[ny * cellsX + xEnd + 1];
+            if (begin < end) f(begin, end);
+        }
+    }
+
+    const float* sortedX() const { return cellX.data(); }
+    const float* sortedY() const { return cellY.data(); }
+    int sortedIndex(int k) const { return cellParticles[k]; }
+
+    float getCutoff() const { return cutoff; }
+
+private:
+    int cellCoord(float v, int cells) const;
+    int cellIndex(float x, float y) const;
+    void sortByCell();
+
+    float cutoff;
+    float cellSize;
+    int cellsX, cellsY;
+
+    std::vector<int> cellStart;      // First entry of each cell in cellParticles (numCells + 1 entries)
+    std::vector<int> cellParticles;  // Particle indices ordered by cell
+    std::vector<int> particleCell;   // Cell of each particle
+    std::vector<int> cellFill;       // Scratch insertion cursor per cell
+    AlignedFloats cellX, cellY;      // Particle coordinates in cellParticles order
+    AlignedFloats coordX, coordY;    // Scratch copy of the positions of build(particles)
+};
+
+#endif
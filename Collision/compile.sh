@@ -1,5 +1,5 @@
 #!/bin/bash
 
-g++ -o fluid_simulation fluid_simulation.cpp -lsfml-graphics -lsfml-window -lsfml-system;
+g++ -O2 -o fluid_simulation fluid_simulation.cpp cell_list.cpp thread_pool.cpp repulsion_kernel.cpp glow_renderer.cpp -pthread -lsfml-graphics -lsfml-window -lsfml-system;
 
 ./fluid_simulation
@@ -2,6 +2,12 @@
 #include <vector>
 #include <cmath>
 #include <cstdlib>
+#include <iostream>
+#include "cell_list.hpp"
+#include "thread_pool.hpp"
+#include "particle_store.hpp"
+#include "repulsion_kernel.hpp"
+#include "glow_renderer.hpp"
 
 const int WINDOW_SIZE = 500;
 const int NUM_PARTICLES = 700;
@@ -12,80 +18,125 @@ const float SIGMA = 20.0f; // Controls the width of the Gaussian function
 const float ATTRACTOR_STRENGTH = 5000.0f; // Strength of the attractor force
 const float MIN_DISTANCE = 500.0f; // Minimum distance at which the attractor starts influencing
 const float DENSITY_RADIUS = 30.0f; // Radius to consider for density calculation
-
-struct Particle {
-    sf::Vector2f position;
-    sf::Vector2f velocity;
-    float density; // New density attribute
-
-    Particle(float x, float y, float vx, float vy)
-        : position(x, y), velocity(vx, vy), density(0.0f) {}
+const float REPULSION_CUTOFF = 3.0f * SIGMA; // The Gaussian is below 1.2% of its amplitude past 3 sigma
+const float GLOW_RADIUS = PARTICLE_RADIUS + 4.5f; // Outer radius of the glow around each particle
+const float NEIGHBOR_CUTOFF = REPULSION_CUTOFF > DENSITY_RADIUS ? REPULSION_CUTOFF : DENSITY_RADIUS; // Cell size of the neighbor grid
+const float PHYSICS_DT = 1.0f / 1000.0f; // Fixed physics time step (1 kHz)
+const int MAX_SUBSTEPS_PER_FRAME = 50; // Physics steps allowed per rendered frame, the rest of a slow frame is dropped
+const float FRAME_RATE = 60; // Rendering rate
+
+// Forces and density of one particle, computed from a snapshot of all particles
+struct ParticleForce {
+    sf::Vector2f acceleration;
+    float density;
 };
 
-float gaussianRepulsion(float distance) {
-    return REPULSION_FORCE_AMPLITUDE * std::exp(-distance * distance / (2 * SIGMA * SIGMA));
-}
-
-void updateParticle(Particle& particle, const std::vector<Particle>& particles, float dt, const sf::Vector2f& attractorPosition, bool isAttracting) {
-    // Initialize repulsion force to zero
-    sf::Vector2f repulsionForce(0.0f, 0.0f);
-
-    // Reset the particle's density
-    particle.density = 0.0f;
+ParticleForce computeForce(int i, const ParticleStore& particles, const CellList& cells, RepulsionKernel kernel, const sf::Vector2f& attractorPosition, bool isAttracting) {
+    static const RepulsionParams params = {
+        REPULSION_FORCE_AMPLITUDE,
+        1.0f / (2 * SIGMA * SIGMA),
+        REPULSION_CUTOFF * REPULSION_CUTOFF,
+        DENSITY_RADIUS * DENSITY_RADIUS,
+        0.1f * 0.1f // Avoid division by zero, also skips the particle itself
+    };
 
-    // Calculate the repulsion force from all other particles and compute density
-    for (const auto& other : particles) {
-        if (&particle != &other) { // Don't apply force from itself
-            sf::Vector2f diff = particle.position - other.position;
-            float distance = std::sqrt(diff.x * diff.x + diff.y * diff.y);
-
-            if (distance > 0.1f) { // Avoid division by zero
-                float forceMagnitude = gaussianRepulsion(distance);
-                repulsionForce += forceMagnitude * (diff / distance);
-
-                // Calculate density based on proximity
-                if (distance < DENSITY_RADIUS) {
-                    particle.density += 1.0f; // Increment density for nearby particles
-                }
-            }
-        }
-    }
+    ParticleForce result{sf::Vector2f(0.0f, 0.0f), 0.0f};
+    sf::Vector2f position(particles.x[i], particles.y[i]);
 
-    // Apply the repulsion force to the particle's velocity
-    particle.velocity += repulsionForce * dt;
+    // Calculate the repulsion force from the neighboring particles and compute density
+    cells.forEachNeighborRange(position.x, position.y, [&](int begin, int end) {
+        kernel(position.x, position.y, cells.sortedX(), cells.sortedY(), begin, end, params,
+               result.acceleration.x, result.acceleration.y, result.density);
+    });
 
     // Apply the attractor force if the particle is within the influence range and attraction is active
     if (isAttracting) {
-        sf::Vector2f attractorDiff = attractorPosition - particle.position;
+        sf::Vector2f attractorDiff = attractorPosition - position;
         float attractorDistance = std::sqrt(attractorDiff.x * attractorDiff.x + attractorDiff.y * attractorDiff.y);
         if (attractorDistance < MIN_DISTANCE) {
             float attractorForceMagnitude = ATTRACTOR_STRENGTH / (attractorDistance + 0.1f); // Avoid division by zero
-            particle.velocity += attractorForceMagnitude * (attractorDiff / attractorDistance) * dt;
+            result.acceleration += attractorForceMagnitude * (attractorDiff / attractorDistance);
         }
     }
 
-    // Update the particle's position
-    particle.position += particle.velocity * dt;
+    return result;
+}
+
+// First half of a velocity-Verlet step: half kick with the current acceleration, then drift
+void kickDrift(int i, ParticleStore& particles, float dt) {
+    float& x = particles.x[i];
+    float& y = particles.y[i];
+    float& vx = particles.vx[i];
+    float& vy = particles.vy[i];
+
+    vx += 0.5f * particles.ax[i] * dt;
+    vy += 0.5f * particles.ay[i] * dt;
+    x += vx * dt;
+    y += vy * dt;
 
     // Bounce off walls
-    if (particle.position.x < PARTICLE_RADIUS) {
-        particle.position.x = PARTICLE_RADIUS;
-        particle.velocity.x *= -1;
+    if (x < PARTICLE_RADIUS) {
+        x = PARTICLE_RADIUS;
+        vx *= -1;
     }
-    if (particle.position.x > WINDOW_SIZE - PARTICLE_RADIUS) {
-        particle.position.x = WINDOW_SIZE - PARTICLE_RADIUS;
-        particle.velocity.x *= -1;
+    if (x > WINDOW_SIZE - PARTICLE_RADIUS) {
+        x = WINDOW_SIZE - PARTICLE_RADIUS;
+        vx *= -1;
     }
-    if (particle.position.y < PARTICLE_RADIUS) {
-        particle.position.y = PARTICLE_RADIUS;
-        particle.velocity.y *= -1;
+    if (y < PARTICLE_RADIUS) {
+        y = PARTICLE_RADIUS;
+        vy *= -1;
     }
-    if (particle.position.y > WINDOW_SIZE - PARTICLE_RADIUS) {
-        particle.position.y = WINDOW_SIZE - PARTICLE_RADIUS;
-        particle.velocity.y *= -1;
+    if (y > WINDOW_SIZE - PARTICLE_RADIUS) {
+        y = WINDOW_SIZE - PARTICLE_RADIUS;
+        vy *= -1;
     }
 }
 
+// Second half of a velocity-Verlet step: store the new acceleration and kick with it
+void kick(int i, ParticleStore& particles, const ParticleForce& force, float dt) {
+    particles.ax[i] = force.acceleration.x;
+    particles.ay[i] = force.acceleration.y;
+    particles.density[i] = force.density;
+
+    particles.vx[i] += 0.5f * particles.ax[i] * dt;
+    particles.vy[i] += 0.5f * particles.ay[i] * dt;
+}
+
+// Evaluate the forces on all particles from one snapshot of the positions.
+// Each particle is handled by exactly one thread, so the result does not depend on the thread count.
+void computeForces(ParticleStore& particles, std::vector<ParticleForce>& forces, CellList& cells, ThreadPool& pool, RepulsionKernel kernel, const sf::Vector2f& attractorPosition, bool isAttracting) {
+    int count = particles.size();
+    forces.resize(count);
+    cells.build(particles.x.data(), particles.y.data(), count);
+
+    pool.parallelFor(count, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            forces[i] = computeForce(i, particles, cells, kernel, attractorPosition, isAttracting);
+        }
+    });
+}
+
+// Advance all particles by one velocity-Verlet (kick-drift-kick) step of dt.
+// The accelerations in the store must come from the current positions.
+void stepParticles(ParticleStore& particles, std::vector<ParticleForce>& forces, CellList& cells, ThreadPool& pool, RepulsionKernel kernel, float dt, const sf::Vector2f& attractorPosition, bool isAttracting) {
+    int count = particles.size();
+
+    pool.parallelFor(count, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            kickDrift(i, particles, dt);
+        }
+    });
+
+    computeForces(particles, forces, cells, pool, kernel, attractorPosition, isAttracting);
+
+    pool.parallelFor(count, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            kick(i, particles, forces[i], dt);
+        }
+    });
+}
+
 sf::Color densityToColor(float density) {
     // Map the density to a color between blue (low) and red (high)
     int red = std::min(255, static_cast<int>(density * 255.0f / 15.0f));
@@ -93,36 +144,40 @@ sf::Color densityToColor(float density) {
     return sf::Color(red, 0, blue, 255); // Ensure alpha is 255
 }
 
-void drawGlowingParticle(sf::RenderWindow& window, const sf::Vector2f& position, sf::Color color) {
-    // Draw multiple layers of circles to create a glow effect
-    for (int i = 0; i < 10; ++i) {
-        sf::CircleShape shape(PARTICLE_RADIUS + i * .5f);
-        shape.setOrigin(shape.getRadius(), shape.getRadius());
-        shape.setPosition(position);
-        sf::Color layerColor = color;
-        layerColor.a = static_cast<sf::Uint8>(255 - i * 50); // Gradually decrease alpha
-        shape.setFillColor(layerColor);
-        window.draw(shape);
-    }
-}
-
 int main() {
     sf::RenderWindow window(sf::VideoMode(WINDOW_SIZE, WINDOW_SIZE), "Particle Fluid Simulation with Attractor and Glow Effect");
+    window.setFramerateLimit(FRAME_RATE);
    
     // Create particles
-    std::vector<Particle> particles;
+    ParticleStore particles;
     for (int i = 0; i < NUM_PARTICLES; ++i) {
         float x = static_cast<float>(rand() % WINDOW_SIZE);
         float y = static_cast<float>(rand() % WINDOW_SIZE);
         float vx = static_cast<float>((rand() % 100 - 50) / VELOCITY_SCALE);
         float vy = static_cast<float>((rand() % 100 - 50) / VELOCITY_SCALE);
-        particles.emplace_back(x, y, vx, vy);
+        particles.add(x, y, vx, vy);
     }
 
-    sf::Clock clock;
+    // Neighbor grid, rebuilt once per step
+    CellList cells(WINDOW_SIZE, WINDOW_SIZE, NEIGHBOR_CUTOFF);
+    std::vector<ParticleForce> forces(particles.size());
+    ThreadPool pool; // One thread per core
+    RepulsionKernel kernel = repulsion::select(); // Widest SIMD kernel of this CPU
+    std::cout << NUM_PARTICLES << " particles, " << repulsion::name(kernel) << " repulsion kernel" << std::endl;
+    GlowRenderer renderer(GLOW_RADIUS);
+
     sf::Vector2f attractorPosition(-1.0f, -1.0f); // Initial invalid position
     bool isAttracting = false; // Track whether the mouse is pressed
 
+    // Initial accelerations for the first Verlet step
+    computeForces(particles, forces, cells, pool, kernel, attractorPosition, isAttracting);
+    for (int i = 0; i < particles.size(); ++i) {
+        kick(i, particles, forces[i], 0.0f); // Only stores the acceleration
+    }
+
+    sf::Clock clock;
+    float accumulator = 0.0f; // Real time not yet simulated
+
     while (window.isOpen()) {
         sf::Event event;
         while (window.pollEvent(event)) {
@@ -138,20 +193,23 @@ int main() {
             }
         }
 
-        float dt = clock.restart().asSeconds();
-
-        // Update particles with repulsion and attractor forces
-        for (auto& particle : particles) {
-            updateParticle(particle, particles, dt, attractorPosition, isAttracting);
+        // Run as many fixed steps as the elapsed real time allows, so the physics
+        // does not depend on the frame rate
+        accumulator += clock.restart().asSeconds();
+        int substeps = 0;
+        while (accumulator >= PHYSICS_DT && substeps < MAX_SUBSTEPS_PER_FRAME) {
+            stepParticles(particles, forces, cells, pool, kernel, PHYSICS_DT, attractorPosition, isAttracting);
+            accumulator -= PHYSICS_DT;
+            ++substeps;
+        }
+        if (substeps == MAX_SUBSTEPS_PER_FRAME) {
+            accumulator = 0.0f; // Fell behind: slow down instead of piling up work
         }
 
         window.clear(sf::Color(10, 0, 192, 255));
 
-        // Draw particles with a glow effect
-        for (const auto& particle : particles) {
-            sf::Color color = densityToColor(particle.density); // Set the color based on density
-            drawGlowingParticle(window, particle.position, color);
-        }
+        // Draw particles with a glow effect, colored by density
+        renderer.draw(window, particles, densityToColor);
 
         window.display();
     }
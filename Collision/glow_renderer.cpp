@@ -0,0 +1,42 @@
+#include "glow_renderer.hpp"
+#include <algorithm>
+#include <cmath>
+
+GlowRenderer::GlowRenderer(float radius, unsigned textureSize)
+    : radius(radius), vertices(sf::Quads) {
+    // White disc whose alpha falls off quadratically from the center,
+    // the vertex color tints it per particle
+    sf::Image image;
+    image.create(textureSize, textureSize, sf::Color(255, 255, 255, 0));
+    float center = 0.5f * textureSize;
+    for (unsigned y = 0; y < textureSize; ++y) {
+        for (unsigned x = 0; x < textureSize; ++x) {
+            float dx = (x + 0.5f - center) / center;
+            float dy = (y + 0.5f - center) / center;
+            float falloff = std::max(0.0f, 1.0f - std::sqrt(dx * dx + dy * dy));
+            image.setPixel(x, y, sf::Color(255, 255, 255, static_cast<sf::Uint8>(255 * falloff * falloff)));
+        }
+    }
+    glowTexture.loadFromImage(image);
+    glowTexture.setSmooth(true);
+}
+
+void GlowRenderer::draw(sf::RenderTarget& target, const ParticleStore& particles, sf::Color (*colorOf)(float density)) {
+    int count = particles.size();
+    vertices.resize(4 * count);
+
+    float textureSize = static_cast<float>(glowTexture.getSize().x);
+    for (int i = 0; i < count; ++i) {
+        sf::Color color = colorOf(particles.density[i]);
+        float x = particles.x[i];
+        float y = particles.y[i];
+
+        sf::Vertex* quad = &vertices[4 * i];
+        quad[0] = sf::Vertex(sf::Vector2f(x - radius, y - radius), color, sf::Vector2f(0.0f, 0.0f));
+        quad[1] = sf::Vertex(sf::Vector2f(x + radius, y - radius), color, sf::Vector2f(textureSize, 0.0f));
+        quad[2] = sf::Vertex(sf::Vector2f(x + radius, y + radius), color, sf::Vector2f(textureSize, textureSize));
+        quad[3] = sf::Vertex(sf::Vector2f(x - radius, y + radius), color, sf::Vector2f(0.0f, textureSize));
+    }
+
+    target.draw(vertices, sf::RenderStates(&glowTexture));
+}
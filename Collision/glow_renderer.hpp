@@ -0,0 +1,23 @@
+#ifndef GLOW_RENDERER_HPP
+#define GLOW_RENDERER_HPP
+#include <SFML/Graphics.hpp>
+#include "particle_store.hpp"
+
+// Draws every particle as a textured quad in a single draw call.
+//
+// The glow is baked once into a small radial-falloff texture, so the cost per
+// frame is four vertices per particle no matter how soft the glow looks.
+class GlowRenderer {
+public:
+    // radius: outer radius of the glow in pixels
+    explicit GlowRenderer(float radius, unsigned textureSize = 64);
+
+    void draw(sf::RenderTarget& target, const ParticleStore& particles, sf::Color (*colorOf)(float density));
+
+private:
+    float radius;
+    sf::Texture glowTexture;
+    sf::VertexArray vertices;
+};
+
+#endif
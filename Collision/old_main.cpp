@@ -2,6 +2,7 @@
 #include <vector>
 #include <cmath>
 #include <cstdlib>
+#include "cell_list.hpp"
 
 const int WINDOW_SIZE = 600;
 const int NUM_PARTICLES = 600;
@@ -11,6 +12,7 @@ const float REPULSION_FORCE_AMPLITUDE = 100.0f; // Amplitude of the Gaussian fun
 const float SIGMA = 50.0f; // Controls the width of the Gaussian function
 const float ATTRACTOR_STRENGTH = 5000.0f; // Strength of the attractor force
 const float MIN_DISTANCE = 500.0f; // Minimum distance at which the attractor starts influencing
+const float REPULSION_CUTOFF = 3.0f * SIGMA; // The Gaussian is below 1.2% of its amplitude past 3 sigma
 
 struct Particle {
     sf::Vector2f position;
@@ -24,22 +26,25 @@ float gaussianRepulsion(float distance) {
     return REPULSION_FORCE_AMPLITUDE * std::exp(-distance * distance / (2 * SIGMA * SIGMA));
 }
 
-void updateParticle(Particle& particle, const std::vector<Particle>& particles, float dt, const sf::Vector2f& attractorPosition, bool isAttracting) {
+void updateParticle(Particle& particle, const std::vector<Particle>& particles, const CellList& cells, float dt, const sf::Vector2f& attractorPosition, bool isAttracting) {
     // Initialize repulsion force to zero
     sf::Vector2f repulsionForce(0.0f, 0.0f);
 
-    // Calculate the repulsion force from all other particles
-    for (const auto& other : particles) {
-        if (&particle != &other) { // Don't apply force from itself
-            sf::Vector2f diff = particle.position - other.position;
-            float distance = std::sqrt(diff.x * diff.x + diff.y * diff.y);
+    // Calculate the repulsion force from the neighboring particles
+    cells.forEachNeighbor(particle.position.x, particle.position.y, [&](int j) {
+        const Particle& other = particles[j];
+        if (&particle == &other) return; // Don't apply force from itself
 
-            if (distance > 0.1f) { // Avoid division by zero
-                float forceMagnitude = gaussianRepulsion(distance);
-                repulsionForce += forceMagnitude * (diff / distance);
-            }
+        sf::Vector2f diff = particle.position - other.position;
+        float distanceSquared = diff.x * diff.x + diff.y * diff.y;
+        if (distanceSquared >= REPULSION_CUTOFF * REPULSION_CUTOFF) return;
+
+        float distance = std::sqrt(distanceSquared);
+        if (distance > 0.1f) { // Avoid division by zero
+            float forceMagnitude = gaussianRepulsion(distance);
+            repulsionForce += forceMagnitude * (diff / distance);
         }
-    }
+    });
 
     // Apply the repulsion force to the particle's velocity
     particle.velocity += repulsionForce * dt;
@@ -89,6 +94,9 @@ int main() {
         particles.emplace_back(x, y, vx, vy);
     }
 
+    // Neighbor grid, rebuilt once per step
+    CellList cells(WINDOW_SIZE, WINDOW_SIZE, REPULSION_CUTOFF);
+
     sf::Clock clock;
     sf::Vector2f attractorPosition(-1.0f, -1.0f); // Initial invalid position
     bool isAttracting = false; // Track whether the mouse is pressed
@@ -111,8 +119,9 @@ int main() {
         float dt = clock.restart().asSeconds();
 
         // Update particles with repulsion and attractor forces
+        cells.build(particles);
         for (auto& particle : particles) {
-            updateParticle(particle, particles, dt, attractorPosition, isAttracting);
+            updateParticle(particle, particles, cells, dt, attractorPosition, isAttracting);
         }
 
         window.clear();
@@ -0,0 +1,59 @@
+#ifndef PARTICLE_STORE_HPP
+#define PARTICLE_STORE_HPP
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Minimal allocator returning memory aligned for 256-bit vector loads
+template <typename T, std::size_t Alignment = 32>
+struct AlignedAllocator {
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+    AlignedAllocator() {}
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(std::size_t n) {
+        // aligned_alloc wants the size to be a multiple of the alignment
+        std::size_t bytes = (n * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+        void* ptr = std::aligned_alloc(Alignment, bytes == 0 ? Alignment : bytes);
+        if (!ptr) throw std::bad_alloc();
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, std::size_t) { std::free(ptr); }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+typedef std::vector<float, AlignedAllocator<float>> AlignedFloats;
+
+// Structure-of-arrays particle storage: one contiguous, aligned array per
+// component so the force loop can load 8 neighbors with a single instruction.
+struct ParticleStore {
+    AlignedFloats x, y;    // Position
+    AlignedFloats vx, vy;  // Velocity
+    AlignedFloats ax, ay;  // Acceleration at the current position
+    AlignedFloats density; // Neighbor count within DENSITY_RADIUS
+
+    int size() const { return static_cast<int>(x.size()); }
+
+    void add(float px, float py, float pvx, float pvy) {
+        x.push_back(px);
+        y.push_back(py);
+        vx.push_back(pvx);
+        vy.push_back(pvy);
+        ax.push_back(0.0f);
+        ay.push_back(0.0f);
+        density.push_back(0.0f);
+    }
+};
+
+#endif
@@ -0,0 +1,225 @@
+#include "repulsion_kernel.hpp"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define REPULSION_X86 1
+#endif
+
+void repulsion::scalar(float px, float py, const float* xs, const float* ys, int begin, int end,
+                       const RepulsionParams& params, float& forceX, float& forceY, float& density) {
+    for (int j = begin; j < end; ++j) {
+        float dx = px - xs[j];
+        float dy = py - ys[j];
+        float distanceSquared = dx * dx + dy * dy;
+        if (distanceSquared <= params.minDistanceSquared) continue; // Itself, or too close to normalize
+
+        if (distanceSquared < params.cutoffSquared) {
+            float distance = std::sqrt(distanceSquared);
+            float forceMagnitude = params.amplitude * std::exp(-distanceSquared * params.inverseTwoSigmaSquared);
+            forceX += forceMagnitude * dx / distance;
+            forceY += forceMagnitude * dy / distance;
+        }
+        if (distanceSquared < params.densityRadiusSquared) {
+            density += 1.0f;
+        }
+    }
+}
+
+#ifdef REPULSION_X86
+
+/* Vectorized exp for x <= 0.
+ *
+ * exp(x) = 2^n * exp(r) with n = round(x / ln2) and |r| <= ln2 / 2; exp(r) is a
+ * degree 6 Taylor polynomial (relative error below 2e-7, i.e. float precision)
+ * and 2^n is built directly in the exponent bits. Inputs are clamped at -87 so
+ * the result stays a normal float instead of underflowing.
+ */
+__attribute__((target("avx2,fma")))
+static inline __m256 fastExpAvx2(__m256 x) {
+    const __m256 log2e = _mm256_set1_ps(1.44269504f);
+    const __m256 ln2 = _mm256_set1_ps(0.693147181f);
+
+    x = _mm256_max_ps(x, _mm256_set1_ps(-87.0f));
+    __m256 n = _mm256_round_ps(_mm256_mul_ps(x, log2e), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(n, ln2, x);
+
+    __m256 p = _mm256_set1_ps(1.0f / 720.0f);
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.0f / 120.0f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.0f / 24.0f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.0f / 6.0f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(0.5f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.0f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.0f));
+
+    __m256i exponent = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(exponent));
+}
+
+__attribute__((target("avx2,fma")))
+static inline float horizontalSumAvx2(__m256 v) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+    return _mm_cvtss_f32(sum);
+}
+
+__attribute__((target("avx2,fma")))
+void repulsion::avx2(float px, float py, const float* xs, const float* ys, int begin, int end,
+                     const RepulsionParams& params, float& forceX, float& forceY, float& density) {
+    const __m256 vpx = _mm256_set1_ps(px);
+    const __m256 vpy = _mm256_set1_ps(py);
+    const __m256 amplitude = _mm256_set1_ps(params.amplitude);
+    const __m256 negInverseTwoSigmaSquared = _mm256_set1_ps(-params.inverseTwoSigmaSquared);
+    const __m256 cutoffSquared = _mm256_set1_ps(params.cutoffSquared);
+    const __m256 densityRadiusSquared = _mm256_set1_ps(params.densityRadiusSquared);
+    const __m256 minDistanceSquared = _mm256_set1_ps(params.minDistanceSquared);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 threeHalves = _mm256_set1_ps(1.5f);
+    const __m256i laneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    __m256 accX = _mm256_setzero_ps();
+    __m256 accY = _mm256_setzero_ps();
+    __m256 accDensity = _mm256_setzero_ps();
+
+    for (int j = begin; j < end; j += 8) {
+        // The last iteration loads only the lanes that are still in range
+        __m256i inRange = _mm256_cmpgt_epi32(_mm256_set1_epi32(end - j), laneIndex);
+        __m256 ox = _mm256_maskload_ps(xs + j, inRange);
+        __m256 oy = _mm256_maskload_ps(ys + j, inRange);
+
+        __m256 dx = _mm256_sub_ps(vpx, ox);
+        __m256 dy = _mm256_sub_ps(vpy, oy);
+        __m256 distanceSquared = _mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dy, dy));
+
+        __m256 valid = _mm256_and_ps(_mm256_castsi256_ps(inRange),
+                                     _mm256_cmp_ps(distanceSquared, minDistanceSquared, _CMP_GT_OQ));
+        __m256 repel = _mm256_and_ps(valid, _mm256_cmp_ps(distanceSquared, cutoffSquared, _CMP_LT_OQ));
+        __m256 dense = _mm256_and_ps(valid, _mm256_cmp_ps(distanceSquared, densityRadiusSquared, _CMP_LT_OQ));
+        accDensity = _mm256_add_ps(accDensity, _mm256_and_ps(dense, one));
+        if (_mm256_movemask_ps(repel) == 0) continue;
+
+        // 1 / distance from rsqrt plus one Newton step
+        __m256 inverseDistance = _mm256_rsqrt_ps(distanceSquared);
+        __m256 correction = _mm256_mul_ps(_mm256_mul_ps(half, distanceSquared), _mm256_mul_ps(inverseDistance, inverseDistance));
+        inverseDistance = _mm256_mul_ps(inverseDistance, _mm256_sub_ps(threeHalves, correction));
+
+        __m256 forceMagnitude = _mm256_mul_ps(amplitude, fastExpAvx2(_mm256_mul_ps(distanceSquared, negInverseTwoSigmaSquared)));
+        __m256 scale = _mm256_and_ps(repel, _mm256_mul_ps(forceMagnitude, inverseDistance));
+        accX = _mm256_fmadd_ps(scale, dx, accX);
+        accY = _mm256_fmadd_ps(scale, dy, accY);
+    }
+
+    forceX += horizontalSumAvx2(accX);
+    forceY += horizontalSumAvx2(accY);
+    density += horizontalSumAvx2(accDensity);
+}
+
+// Same as fastExpAvx2 without FMA
+__attribute__((target("sse4.1")))
+static inline __m128 fastExpSse(__m128 x) {
+    const __m128 log2e = _mm_set1_ps(1.44269504f);
+    const __m128 ln2 = _mm_set1_ps(0.693147181f);
+
+    x = _mm_max_ps(x, _mm_set1_ps(-87.0f));
+    __m128 n = _mm_round_ps(_mm_mul_ps(x, log2e), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(n, ln2));
+
+    __m128 p = _mm_set1_ps(1.0f / 720.0f);
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f / 120.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f / 24.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f / 6.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(0.5f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f));
+
+    __m128i exponent = _mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(p, _mm_castsi128_ps(exponent));
+}
+
+__attribute__((target("sse4.1")))
+static inline float horizontalSumSse(__m128 v) {
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+}
+
+__attribute__((target("sse4.1")))
+void repulsion::sse(float px, float py, const float* xs, const float* ys, int begin, int end,
+                    const RepulsionParams& params, float& forceX, float& forceY, float& density) {
+    const __m128 vpx = _mm_set1_ps(px);
+    const __m128 vpy = _mm_set1_ps(py);
+    const __m128 amplitude = _mm_set1_ps(params.amplitude);
+    const __m128 negInverseTwoSigmaSquared = _mm_set1_ps(-params.inverseTwoSigmaSquared);
+    const __m128 cutoffSquared = _mm_set1_ps(params.cutoffSquared);
+    const __m128 densityRadiusSquared = _mm_set1_ps(params.densityRadiusSquared);
+    const __m128 minDistanceSquared = _mm_set1_ps(params.minDistanceSquared);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 threeHalves = _mm_set1_ps(1.5f);
+
+    __m128 accX = _mm_setzero_ps();
+    __m128 accY = _mm_setzero_ps();
+    __m128 accDensity = _mm_setzero_ps();
+
+    int j = begin;
+    for (; j + 4 <= end; j += 4) {
+        __m128 dx = _mm_sub_ps(vpx, _mm_loadu_ps(xs + j));
+        __m128 dy = _mm_sub_ps(vpy, _mm_loadu_ps(ys + j));
+        __m128 distanceSquared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+        __m128 valid = _mm_cmpgt_ps(distanceSquared, minDistanceSquared);
+        __m128 repel = _mm_and_ps(valid, _mm_cmplt_ps(distanceSquared, cutoffSquared));
+        __m128 dense = _mm_and_ps(valid, _mm_cmplt_ps(distanceSquared, densityRadiusSquared));
+        accDensity = _mm_add_ps(accDensity, _mm_and_ps(dense, one));
+        if (_mm_movemask_ps(repel) == 0) continue;
+
+        __m128 inverseDistance = _mm_rsqrt_ps(distanceSquared);
+        __m128 correction = _mm_mul_ps(_mm_mul_ps(half, distanceSquared), _mm_mul_ps(inverseDistance, inverseDistance));
+        inverseDistance = _mm_mul_ps(inverseDistance, _mm_sub_ps(threeHalves, correction));
+
+        __m128 forceMagnitude = _mm_mul_ps(amplitude, fastExpSse(_mm_mul_ps(distanceSquared, negInverseTwoSigmaSquared)));
+        __m128 scale = _mm_and_ps(repel, _mm_mul_ps(forceMagnitude, inverseDistance));
+        accX = _mm_add_ps(accX, _mm_mul_ps(scale, dx));
+        accY = _mm_add_ps(accY, _mm_mul_ps(scale, dy));
+    }
+
+    forceX += horizontalSumSse(accX);
+    forceY += horizontalSumSse(accY);
+    density += horizontalSumSse(accDensity);
+
+    // Remaining pairs
+    scalar(px, py, xs, ys, j, end, params, forceX, forceY, density);
+}
+
+RepulsionKernel repulsion::select() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return &repulsion::avx2;
+    if (__builtin_cpu_supports("sse4.1")) return &repulsion::sse;
+    return &repulsion::scalar;
+}
+
+#else
+
+void repulsion::sse(float px, float py, const float* xs, const float* ys, int begin, int end,
+                    const RepulsionParams& params, float& forceX, float& forceY, float& density) {
+    scalar(px, py, xs, ys, begin, end, params, forceX, forceY, density);
+}
+
+void repulsion::avx2(float px, float py, const float* xs, const float* ys, int begin, int end,
+                     const RepulsionParams& params, float& forceX, float& forceY, float& density) {
+    scalar(px, py, xs, ys, begin, end, params, forceX, forceY, density);
+}
+
+RepulsionKernel repulsion::select() {
+    return &repulsion::scalar;
+}
+
+#endif
+
+const char* repulsion::name(RepulsionKernel kernel) {
+    if (kernel == &repulsion::avx2) return "AVX2";
+    if (kernel == &repulsion::sse) return "SSE4.1";
+    return "scalar";
+}
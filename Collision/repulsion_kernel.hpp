@@ -0,0 +1,36 @@
+#ifndef REPULSION_KERNEL_HPP
+#define REPULSION_KERNEL_HPP
+
+// Constants of the pairwise Gaussian repulsion, in the form the kernels use them
+struct RepulsionParams {
+    float amplitude;              // REPULSION_FORCE_AMPLITUDE
+    float inverseTwoSigmaSquared; // 1 / (2 sigma^2)
+    float cutoffSquared;          // Pairs further apart feel no repulsion
+    float densityRadiusSquared;   // Pairs closer than this count towards the density
+    float minDistanceSquared;     // Pairs closer than this are ignored (self, overlaps)
+};
+
+// Accumulate the repulsion on a particle at (px, py) from the particles
+// [begin, end) of the coordinate arrays xs/ys, and count its close neighbors.
+typedef void (*RepulsionKernel)(float px, float py, const float* xs, const float* ys, int begin, int end,
+                                const RepulsionParams& params, float& forceX, float& forceY, float& density);
+
+namespace repulsion {
+
+    void scalar(float px, float py, const float* xs, const float* ys, int begin, int end,
+                const RepulsionParams& params, float& forceX, float& forceY, float& density);
+
+    // SSE4.1, 4 pairs per iteration
+    void sse(float px, float py, const float* xs, const float* ys, int begin, int end,
+             const RepulsionParams& params, float& forceX, float& forceY, float& density);
+
+    // AVX2 + FMA, 8 pairs per iteration
+    void avx2(float px, float py, const float* xs, const float* ys, int begin, int end,
+              const RepulsionParams& params, float& forceX, float& forceY, float& density);
+
+    // Fastest kernel the running CPU supports
+    RepulsionKernel select();
+    const char* name(RepulsionKernel kernel);
+}
+
+#endif
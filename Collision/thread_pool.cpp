@@ -0,0 +1,70 @@
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    for (unsigned id = 1; id < threads; ++id) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, id);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void ThreadPool::chunk(unsigned id, int& begin, int& end) const {
+    // Static partition, so a given thread count always gets the same chunks
+    long long n = size();
+    begin = static_cast<int>(taskCount * static_cast<long long>(id) / n);
+    end = static_cast<int>(taskCount * static_cast<long long>(id + 1) / n);
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int begin, int end)>& body) {
+    if (workers.empty() || count < 2) {
+        body(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &body;
+        taskCount = count;
+        pending = static_cast<unsigned>(workers.size());
+        ++generation;
+    }
+    wake.notify_all();
+
+    int begin, end;
+    chunk(0, begin, end);
+    if (begin < end) body(begin, end);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending == 0; });
+    task = nullptr;
+}
+
+void ThreadPool::workerLoop(unsigned id) {
+    unsigned seen = 0;
+    while (true) {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+
+        int begin, end;
+        chunk(id, begin, end);
+        const std::function<void(int, int)>* body = task;
+        lock.unlock();
+
+        if (begin < end) (*body)(begin, end);
+
+        lock.lock();
+        if (--pending == 0) done.notify_one();
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops.
+//
+// parallelFor splits [0, count) into one contiguous chunk per thread and blocks
+// until every chunk is done. The calling thread works on the first chunk, so a
+// pool of size 1 runs everything inline without any synchronization.
+class ThreadPool {
+public:
+    // threads = 0 uses one thread per hardware core
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void parallelFor(int count, const std::function<void(int begin, int end)>& body);
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+private:
+    void workerLoop(unsigned id);
+    void chunk(unsigned id, int& begin, int& end) const;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(int, int)>* task = nullptr;
+    int taskCount = 0;
+    unsigned generation = 0;  // Bumped for every parallelFor call
+    unsigned pending = 0;     // Workers still busy with the current task
+    bool stopping = false;
+};
+
+#endif
@@ -0,0 +1,174 @@
+#include "checkpoint.hpp"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(CheckpointHeader) == 64, "the checkpoint header must stay 64 bytes");
+
+namespace {
+
+  const char CHECKPOINT_MAGIC[8] = {'G', 'S', 'C', 'H', 'K', 'P', 'T', '\0'};
+
+  std::size_t expectedSize(const CheckpointHeader& header) {
+    return sizeof(CheckpointHeader) + 2 * sizeof(float) * static_cast<std::size_t>(header.width) * header.height;
+  }
+
+  bool writeFields(const std::string& path, const Params& params, const Field& u, const Field& v,
+                   unsigned seed, long long step) {
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.width = u.width();
+    header.height = u.height();
+    header.du = params.du;
+    header.dv = params.dv;
+    header.feed = params.feed;
+    header.kill = params.kill;
+    header.deltaT = params.deltaT;
+    header.seed = seed;
+    header.step = step;
+
+    std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) return false;
+
+    int width = u.width();
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int y = 0; y < u.height() && ok; ++y) ok = std::fwrite(u.row(y), sizeof(float), width, file) == static_cast<size_t>(width);
+    for (int y = 0; y < v.height() && ok; ++y) ok = std::fwrite(v.row(y), sizeof(float), width, file) == static_cast<size_t>(width);
+
+    // On disk before the rename, or a crash could leave an empty file under the final name
+    ok = ok && std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = std::fclose(file) == 0 && ok;
+    if (ok) ok = std::rename(temporary.c_str(), path.c_str()) == 0;
+    if (!ok) std::remove(temporary.c_str());
+    return ok;
+  }
+}
+
+bool writeCheckpoint(const std::string& path, const Grid& grid, unsigned seed, long long step) {
+  return writeFields(path, grid.params, grid.u, grid.v, seed, step);
+}
+
+MappedCheckpoint::~MappedCheckpoint() {
+  if (data) munmap(data, size);
+}
+
+bool MappedCheckpoint::open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "Could not open " << path << std::endl;
+    return false;
+  }
+
+  struct stat status;
+  if (fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(CheckpointHeader)) {
+    std::cerr << path << " is not a checkpoint (too short)" << std::endl;
+    close(fd);
+    return false;
+  }
+
+  size = static_cast<std::size_t>(status.st_size);
+  data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // The mapping keeps the file alive
+  if (data == MAP_FAILED) {
+    data = nullptr;
+    std::cerr << "Could not map " << path << std::endl;
+    return false;
+  }
+  madvise(data, size, MADV_SEQUENTIAL);
+
+  const CheckpointHeader& h = header();
+  const char* problem = nullptr;
+  if (std::memcmp(h.magic, CHECKPOINT_MAGIC, sizeof(h.magic)) != 0) problem = "is not a checkpoint";
+  else if (h.version != CHECKPOINT_VERSION) problem = "has an unsupported version or byte order";
+  else if (h.width < 1 || h.height < 1 || size != expectedSize(h)) problem = "is truncated or has a bad size";
+
+  if (problem) {
+    std::cerr << path << " " << problem << std::endl;
+    munmap(data, size);
+    data = nullptr;
+    return false;
+  }
+  return true;
+}
+
+Params MappedCheckpoint::params() const {
+  const CheckpointHeader& h = header();
+  Params params;
+  params.width = h.width;
+  params.height = h.height;
+  params.du = h.du;
+  params.dv = h.dv;
+  params.feed = h.feed;
+  params.kill = h.kill;
+  params.deltaT = h.deltaT;
+  return params;
+}
+
+void MappedCheckpoint::load(Grid& grid) const {
+  int width = header().width;
+  int height = header().height;
+  const float* u = reinterpret_cast<const float*>(static_cast<const char*>(data) + sizeof(CheckpointHeader));
+  const float* v = u + static_cast<std::size_t>(width) * height;
+
+  for (int y = 0; y < height; ++y) {
+    std::memcpy(grid.u.row(y), u + static_cast<std::size_t>(y) * width, width * sizeof(float));
+    std::memcpy(grid.v.row(y), v + static_cast<std::size_t>(y) * width, width * sizeof(float));
+  }
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& path)
+    : path(path), snapshotU(0, 0), snapshotV(0, 0), worker(&CheckpointWriter::workerLoop, this) {}
+
+CheckpointWriter::~CheckpointWriter() {
+  finish();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  worker.join();
+}
+
+void CheckpointWriter::save(const Grid& grid, unsigned seed, long long step) {
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [this] { return !pending; });
+  snapshotParams = grid.params;
+  snapshotU = grid.u;
+  snapshotV = grid.v;
+  snapshotSeed = seed;
+  snapshotStep = step;
+  pending = true;
+  lock.unlock();
+  wake.notify_one();
+}
+
+bool CheckpointWriter::finish() {
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [this] { return !pending; });
+  return !failed;
+}
+
+void CheckpointWriter::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wake.wait(lock, [this] { return stopping || pending; });
+    if (stopping) return;
+
+    // save() blocks while pending is set, so the snapshot is ours
+    lock.unlock();
+    bool ok = writeFields(path, snapshotParams, snapshotU, snapshotV, snapshotSeed, snapshotStep);
+    if (!ok) std::cerr << "Could not write checkpoint " << path << std::endl;
+    lock.lock();
+
+    failed = failed || !ok;
+    pending = false;
+    done.notify_all();
+  }
+}
@@ -0,0 +1,92 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "gray_scott.hpp"
+
+/* Checkpoint files: a 64-byte header followed by the interiors of U and V as
+ * raw floats, row by row (U first). Everything is in the byte order of the
+ * machine that wrote it; the magic number doubles as a byte order check.
+ *
+ * A checkpoint is written to PATH.tmp and renamed over PATH once complete, so
+ * a process killed mid-write leaves the previous checkpoint intact.
+ */
+struct CheckpointHeader {
+  char magic[8];        // "GSCHKPT\0"
+  std::uint32_t version;
+  std::int32_t width, height;
+  float du, dv, feed, kill, deltaT;
+  std::uint32_t seed;   // Seed of initializeGrid, so the run can be repeated from scratch
+  std::uint32_t reserved;
+  std::int64_t step;    // Steps of deltaT done when the checkpoint was taken
+  std::uint8_t padding[8];
+};
+
+const std::uint32_t CHECKPOINT_VERSION = 1;
+
+// Write grid to path synchronously (through path.tmp and a rename)
+bool writeCheckpoint(const std::string& path, const Grid& grid, unsigned seed, long long step);
+
+// A checkpoint file mapped into memory. The fields are copied straight from
+// the page cache into a Grid, without read() buffers in between, and only
+// touched once, so restarting from a large grid costs about one memory copy.
+class MappedCheckpoint {
+public:
+  MappedCheckpoint() {}
+  ~MappedCheckpoint();
+  MappedCheckpoint(const MappedCheckpoint&) = delete;
+  MappedCheckpoint& operator=(const MappedCheckpoint&) = delete;
+
+  // Map the file and check its header and size; prints the reason on failure
+  bool open(const std::string& path);
+
+  Params params() const;
+  unsigned seed() const { return header().seed; }
+  long long step() const { return header().step; }
+
+  // Copy the fields into a grid made from params()
+  void load(Grid& grid) const;
+
+private:
+  const CheckpointHeader& header() const { return *static_cast<const CheckpointHeader*>(data); }
+
+  void* data = nullptr;
+  std::size_t size = 0;
+};
+
+// Writes checkpoints on a background thread. save() copies the fields and
+// returns, so the solver only pauses for one memory copy of the grid; the
+// file is written while it keeps stepping.
+class CheckpointWriter {
+public:
+  explicit CheckpointWriter(const std::string& path);
+  ~CheckpointWriter(); // Finishes the pending write
+
+  // Snapshot the grid and write it in the background. Waits for the previous write first.
+  void save(const Grid& grid, unsigned seed, long long step);
+
+  // Wait for the pending write; false if any write so far failed
+  bool finish();
+
+private:
+  void workerLoop();
+
+  std::string path;
+  Params snapshotParams;
+  Field snapshotU, snapshotV;
+  unsigned snapshotSeed = 0;
+  long long snapshotStep = 0;
+
+  std::mutex mutex;
+  std::condition_variable wake, done;
+  bool pending = false;
+  bool failed = false;
+  bool stopping = false;
+  std::thread worker;
+};
+
+#endif
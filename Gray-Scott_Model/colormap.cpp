@@ -0,0 +1,133 @@
+#include "colormap.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COLORMAP_X86 1
+#endif
+
+void colormap::rowScalar(const float* u, const float* v, int count, const std::uint32_t* lut, std::uint32_t* out) {
+  for (int x = 0; x < count; ++x) {
+    float color = std::min(1.0f, std::max(0.0f, u[x] - v[x]));
+    out[x] = lut[static_cast<int>(color * (LUT_SIZE - 1))];
+  }
+}
+
+#ifdef COLORMAP_X86
+
+__attribute__((target("avx2")))
+void colormap::rowAvx2(const float* u, const float* v, int count, const std::uint32_t* lut, std::uint32_t* out) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 scale = _mm256_set1_ps(static_cast<float>(LUT_SIZE - 1));
+  const int* table = reinterpret_cast<const int*>(lut);
+
+  int x = 0;
+  for (; x + 8 <= count; x += 8) {
+    // Same clamp as rowScalar: max(0, nan) is 0 in both
+    __m256 color = _mm256_sub_ps(_mm256_loadu_ps(u + x), _mm256_loadu_ps(v + x));
+    color = _mm256_min_ps(one, _mm256_max_ps(color, zero));
+    __m256i index = _mm256_cvttps_epi32(_mm256_mul_ps(color, scale));
+    __m256i pixels = _mm256_i32gather_epi32(table, index, 4);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), pixels);
+  }
+
+  // Remaining cells of the row
+  rowScalar(u + x, v + x, count - x, lut, out + x);
+}
+
+RowConverter colormap::select() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return &colormap::rowAvx2;
+  return &colormap::rowScalar;
+}
+
+#else
+
+void colormap::rowAvx2(const float* u, const float* v, int count, const std::uint32_t* lut, std::uint32_t* out) {
+  rowScalar(u, v, count, lut, out);
+}
+
+RowConverter colormap::select() {
+  return &colormap::rowScalar;
+}
+
+#endif
+
+const char* colormap::name(RowConverter converter) {
+  return converter == &colormap::rowAvx2 ? "AVX2" : "scalar";
+}
+
+Colormap::Colormap(RowConverter converter) : lut(colormap::LUT_SIZE), rowConverter(converter) {
+  for (int i = 0; i < colormap::LUT_SIZE; ++i) {
+    float color = static_cast<float>(i) / (colormap::LUT_SIZE - 1);
+
+    // Use color gradient based on U-V values
+    std::uint8_t rgba[4] = {
+      static_cast<std::uint8_t>(color * 255),          // Red channel
+      static_cast<std::uint8_t>((1.0f - color) * 255), // Green channel
+      128,                                             // Blue channel (constant)
+      255                                              // Alpha channel
+    };
+    std::memcpy(&lut[i], rgba, sizeof(rgba)); // Byte order of the texture, whatever the endianness
+  }
+}
+
+void Colormap::convert(const Field& u, const Field& v, std::uint8_t* pixels) const {
+  int width = u.width();
+  std::uint32_t* out = reinterpret_cast<std::uint32_t*>(pixels);
+  for (int y = 0; y < u.height(); ++y) {
+    rowConverter(u.row(y), v.row(y), width, &lut[0], out + static_cast<size_t>(y) * width);
+  }
+}
+
+ColormapStage::ColormapStage(int width, int height)
+    : u(width, height), v(width, height),
+      front(static_cast<size_t>(width) * height * 4), back(static_cast<size_t>(width) * height * 4),
+      worker(&ColormapStage::workerLoop, this) {}
+
+ColormapStage::~ColormapStage() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  worker.join();
+}
+
+void ColormapStage::submit(const Field& newU, const Field& newV) {
+  std::unique_lock<std::mutex> lock(mutex);
+  // The worker may still be reading the previous snapshot; that frame is dropped if nobody waited for it
+  done.wait(lock, [this] { return !pending; });
+  u = newU;
+  v = newV;
+  pending = true;
+  lock.unlock();
+  wake.notify_one();
+}
+
+const std::uint8_t* ColormapStage::wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [this] { return !pending; });
+  if (converted) front.swap(back);
+  converted = false;
+  return front.data();
+}
+
+void ColormapStage::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wake.wait(lock, [this] { return stopping || pending; });
+    if (stopping) return;
+
+    // submit() and wait() block while pending is set, so the snapshot and back buffer are ours
+    lock.unlock();
+    colormap.convert(u, v, back.data());
+    lock.lock();
+
+    pending = false;
+    converted = true;
+    done.notify_all();
+  }
+}
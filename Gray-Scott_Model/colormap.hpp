@@ -0,0 +1,76 @@
+#ifndef COLORMAP_HPP
+#define COLORMAP_HPP
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "field.hpp"
+
+// Convert `count` cells of U and V to RGBA8 pixels (one uint32 per pixel, bytes R, G, B, A in memory)
+// by looking up the clamped u - v in `lut`
+typedef void (*RowConverter)(const float* u, const float* v, int count, const std::uint32_t* lut, std::uint32_t* out);
+
+namespace colormap {
+
+  const int LUT_SIZE = 1024; // Colors for u - v in [0, 1]
+
+  // One table entry per cell, no branches or float to byte conversions
+  void rowScalar(const float* u, const float* v, int count, const std::uint32_t* lut, std::uint32_t* out);
+
+  // 8 cells per instruction: the table lookups are a single gather
+  void rowAvx2(const float* u, const float* v, int count, const std::uint32_t* lut, std::uint32_t* out);
+
+  // Fastest converter the running CPU supports
+  RowConverter select();
+  const char* name(RowConverter converter);
+}
+
+// The red-green gradient of the fields: red where u - v is high, green where it is low
+class Colormap {
+public:
+  explicit Colormap(RowConverter converter = colormap::select());
+
+  // Write width * height RGBA pixels for the interior of the fields
+  void convert(const Field& u, const Field& v, std::uint8_t* pixels) const;
+
+  RowConverter converter() const { return rowConverter; }
+
+private:
+  std::vector<std::uint32_t> lut;
+  RowConverter rowConverter;
+};
+
+// Colormap conversion on a worker thread, so a frame is converted while the
+// solver computes the next batch of steps. submit() copies the fields, and
+// the worker converts the copy into the back pixel buffer; wait() swaps it to
+// the front once it is done. The front buffer stays untouched until the next
+// wait(), so uploading it never races with the conversion.
+class ColormapStage {
+public:
+  ColormapStage(int width, int height);
+  ~ColormapStage();
+
+  // Snapshot the fields and start converting them; returns without waiting
+  void submit(const Field& u, const Field& v);
+
+  // Wait for the last submitted frame and return its pixels (width * height * 4 bytes).
+  // Without a new submit() since the last call, the same pixels are returned again.
+  const std::uint8_t* wait();
+
+private:
+  void workerLoop();
+
+  Colormap colormap;
+  Field u, v;                      // Snapshot being converted
+  std::vector<std::uint8_t> front, back;
+
+  std::mutex mutex;
+  std::condition_variable wake, done;
+  bool pending = false;            // A submitted frame is not converted yet
+  bool converted = false;          // The back buffer holds a frame wait() has not returned yet
+  bool stopping = false;
+  std::thread worker;
+};
+
+#endif
@@ -1,2 +1,2 @@
-g++ -std=c++11 main.cpp -o gray_scott -lsfml-graphics -lsfml-window -lsfml-system
+g++ -std=c++11 -O2 -fopenmp main.cpp gray_scott.cpp stencil_kernel.cpp temporal_blocking.cpp imex.cpp fft.cpp colormap.cpp checkpoint.cpp sweep.cpp -o gray_scott -lsfml-graphics -lsfml-window -lsfml-system
 
@@ -0,0 +1,167 @@
+#include "fft.hpp"
+#include <algorithm>
+#include <cmath>
+
+Fft::Fft(int n) : n(n), twiddleRe(n), twiddleIm(n) {
+  const double pi = 3.14159265358979323846;
+  for (int j = 0; j < n; ++j) {
+    double angle = -2.0 * pi * j / n;
+    twiddleRe[j] = static_cast<float>(std::cos(angle));
+    twiddleIm[j] = static_cast<float>(std::sin(angle));
+  }
+
+  // Radix 4 first, then 2, then odd factors in increasing order
+  int remaining = n;
+  int p = 4;
+  while (remaining > 1) {
+    while (remaining % p != 0) {
+      if (p == 4) p = 2;
+      else if (p == 2) p = 3;
+      else p += 2;
+      if (p * p > remaining) p = remaining; // What is left is prime
+    }
+    remaining /= p;
+    factors.push_back(p);
+    factors.push_back(remaining);
+  }
+  if (factors.empty()) {
+    factors.push_back(1);
+    factors.push_back(1);
+  }
+}
+
+void Fft::run(float* re, float* im, int lanes, int stride, bool inverse) const {
+  static thread_local std::vector<float> outRe, outIm;
+  outRe.resize(static_cast<size_t>(n) * lanes);
+  outIm.resize(static_cast<size_t>(n) * lanes);
+
+  transform(&outRe[0], &outIm[0], re, im, lanes, 1, stride, &factors[0], inverse ? -1.0f : 1.0f);
+
+  for (int k = 0; k < n; ++k) {
+    std::copy(&outRe[k * lanes], &outRe[k * lanes] + lanes, re + static_cast<size_t>(k) * stride);
+    std::copy(&outIm[k * lanes], &outIm[k * lanes] + lanes, im + static_cast<size_t>(k) * stride);
+  }
+}
+
+// out receives the transform of the sequence in[0], in[inStep], in[2 inStep], ...
+// as consecutive rows of `lanes` values
+void Fft::transform(float* outRe, float* outIm, const float* inRe, const float* inIm, int lanes,
+                    int twiddleStep, int inStep, const int* factor, float sign) const {
+  int p = factor[0]; // Radix of this stage
+  int m = factor[1]; // Length of each of the p sub-transforms
+
+  // Decimation in time: transform the p interleaved subsequences into consecutive blocks of out
+  if (m == 1) {
+    for (int q = 0; q < p; ++q) {
+      std::copy(inRe + static_cast<size_t>(q) * inStep, inRe + static_cast<size_t>(q) * inStep + lanes, outRe + q * lanes);
+      std::copy(inIm + static_cast<size_t>(q) * inStep, inIm + static_cast<size_t>(q) * inStep + lanes, outIm + q * lanes);
+    }
+  } else {
+    for (int q = 0; q < p; ++q) {
+      transform(outRe + q * m * lanes, outIm + q * m * lanes,
+                inRe + static_cast<size_t>(q) * inStep, inIm + static_cast<size_t>(q) * inStep,
+                lanes, twiddleStep * p, inStep * p, factor + 2, sign);
+    }
+  }
+
+  // Then combine them
+  switch (p) {
+    case 2: butterfly2(outRe, outIm, lanes, twiddleStep, m, sign); break;
+    case 4: butterfly4(outRe, outIm, lanes, twiddleStep, m, sign); break;
+    default: butterflyGeneric(outRe, outIm, lanes, twiddleStep, m, p, sign); break;
+  }
+}
+
+void Fft::butterfly2(float* re, float* im, int lanes, int twiddleStep, int m, float sign) const {
+  for (int k = 0; k < m; ++k) {
+    const float wr = twiddleRe[k * twiddleStep], wi = sign * twiddleIm[k * twiddleStep];
+    float* aRe = re + k * lanes;
+    float* aIm = im + k * lanes;
+    float* bRe = re + (k + m) * lanes;
+    float* bIm = im + (k + m) * lanes;
+
+    #pragma omp simd
+    for (int b = 0; b < lanes; ++b) {
+      float tRe = bRe[b] * wr - bIm[b] * wi;
+      float tIm = bRe[b] * wi + bIm[b] * wr;
+      bRe[b] = aRe[b] - tRe;
+      bIm[b] = aIm[b] - tIm;
+      aRe[b] += tRe;
+      aIm[b] += tIm;
+    }
+  }
+}
+
+void Fft::butterfly4(float* re, float* im, int lanes, int twiddleStep, int m, float sign) const {
+  for (int k = 0; k < m; ++k) {
+    const float w1r = twiddleRe[k * twiddleStep], w1i = sign * twiddleIm[k * twiddleStep];
+    const float w2r = twiddleRe[2 * k * twiddleStep], w2i = sign * twiddleIm[2 * k * twiddleStep];
+    const float w3r = twiddleRe[3 * k * twiddleStep], w3i = sign * twiddleIm[3 * k * twiddleStep];
+    float* r0 = re + k * lanes;
+    float* i0 = im + k * lanes;
+    float* r1 = re + (k + m) * lanes;
+    float* i1 = im + (k + m) * lanes;
+    float* r2 = re + (k + 2 * m) * lanes;
+    float* i2 = im + (k + 2 * m) * lanes;
+    float* r3 = re + (k + 3 * m) * lanes;
+    float* i3 = im + (k + 3 * m) * lanes;
+
+    #pragma omp simd
+    for (int b = 0; b < lanes; ++b) {
+      float s0r = r1[b] * w1r - i1[b] * w1i, s0i = r1[b] * w1i + i1[b] * w1r;
+      float s1r = r2[b] * w2r - i2[b] * w2i, s1i = r2[b] * w2i + i2[b] * w2r;
+      float s2r = r3[b] * w3r - i3[b] * w3i, s2i = r3[b] * w3i + i3[b] * w3r;
+
+      float s5r = r0[b] - s1r, s5i = i0[b] - s1i;
+      float ar = r0[b] + s1r, ai = i0[b] + s1i;
+      float s3r = s0r + s2r, s3i = s0i + s2i;
+      float s4r = s0r - s2r, s4i = s0i - s2i;
+
+      r0[b] = ar + s3r;
+      i0[b] = ai + s3i;
+      r2[b] = ar - s3r;
+      i2[b] = ai - s3i;
+      // s4 times -i (forward) or +i (inverse)
+      r1[b] = s5r + sign * s4i;
+      i1[b] = s5i - sign * s4r;
+      r3[b] = s5r - sign * s4i;
+      i3[b] = s5i + sign * s4r;
+    }
+  }
+}
+
+// Direct O(p^2) combination, used for radix 3, 5 and any larger prime
+void Fft::butterflyGeneric(float* re, float* im, int lanes, int twiddleStep, int m, int p, float sign) const {
+  static thread_local std::vector<float> scratchRe, scratchIm;
+  scratchRe.resize(static_cast<size_t>(p) * lanes);
+  scratchIm.resize(static_cast<size_t>(p) * lanes);
+
+  for (int u = 0; u < m; ++u) {
+    for (int q = 0, k = u; q < p; ++q, k += m) {
+      std::copy(re + k * lanes, re + (k + 1) * lanes, &scratchRe[q * lanes]);
+      std::copy(im + k * lanes, im + (k + 1) * lanes, &scratchIm[q * lanes]);
+    }
+
+    for (int q1 = 0, k = u; q1 < p; ++q1, k += m) {
+      float* outRe = re + k * lanes;
+      float* outIm = im + k * lanes;
+      std::copy(&scratchRe[0], &scratchRe[0] + lanes, outRe);
+      std::copy(&scratchIm[0], &scratchIm[0] + lanes, outIm);
+
+      int index = 0;
+      for (int q = 1; q < p; ++q) {
+        index += twiddleStep * k;
+        if (index >= n) index -= n;
+        const float wr = twiddleRe[index], wi = sign * twiddleIm[index];
+        const float* sRe = &scratchRe[q * lanes];
+        const float* sIm = &scratchIm[q * lanes];
+
+        #pragma omp simd
+        for (int b = 0; b < lanes; ++b) {
+          outRe[b] += sRe[b] * wr - sIm[b] * wi;
+          outIm[b] += sRe[b] * wi + sIm[b] * wr;
+        }
+      }
+    }
+  }
+}
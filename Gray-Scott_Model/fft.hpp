@@ -0,0 +1,40 @@
+#ifndef FFT_HPP
+#define FFT_HPP
+#include <vector>
+
+// Complex discrete Fourier transform of one fixed length, applied to many
+// sequences at once.
+// Any length works: it is factored into radices 4, 2, 3, 5 and whatever primes
+// are left, and transformed recursively (mixed-radix Cooley-Tukey). Lengths with
+// only small factors, such as the default 400 = 4 * 4 * 5 * 5, are the fast ones.
+//
+// The sequences are stored side by side ("lanes") with real and imaginary parts
+// in separate arrays, so every butterfly is a loop over the lanes with one
+// twiddle factor, which the compiler vectorizes. On a 2D field the lanes are
+// the columns when transforming along y.
+class Fft {
+public:
+  explicit Fft(int n);
+
+  int size() const { return n; }
+
+  // In place: element j of sequence b is (re, im)[j * stride + b], for 0 <= b < lanes.
+  // forward computes sum_j x_j exp(-2 pi i j k / n), inverse the same with +2 pi i.
+  // Neither direction is normalized: inverse(forward(x)) = n * x.
+  void forward(float* re, float* im, int lanes, int stride) const { run(re, im, lanes, stride, false); }
+  void inverse(float* re, float* im, int lanes, int stride) const { run(re, im, lanes, stride, true); }
+
+private:
+  void run(float* re, float* im, int lanes, int stride, bool inverse) const;
+  void transform(float* outRe, float* outIm, const float* inRe, const float* inIm, int lanes,
+                 int twiddleStep, int inStep, const int* factor, float sign) const;
+  void butterfly2(float* re, float* im, int lanes, int twiddleStep, int m, float sign) const;
+  void butterfly4(float* re, float* im, int lanes, int twiddleStep, int m, float sign) const;
+  void butterflyGeneric(float* re, float* im, int lanes, int twiddleStep, int m, int p, float sign) const;
+
+  int n;
+  std::vector<int> factors;                // Pairs (radix, remaining length), ending with remaining length 1
+  std::vector<float> twiddleRe, twiddleIm; // exp(-2 pi i j / n); the inverse flips the sign of the imaginary part
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef FIELD_HPP
+#define FIELD_HPP
+#include <algorithm>
+#include <vector>
+
+// A 2D concentration field stored in one contiguous block, with a one-cell
+// ghost border around it. fillGhosts() copies the opposite edges into the
+// border, after which a 3x3 stencil can read (x +- 1, y +- 1) for every cell
+// of the periodic grid without any modulo.
+class Field {
+public:
+  Field(int width, int height, float value = 0.0f)
+      : w(width), h(height), s(width + 2), data((width + 2) * (height + 2), value) {}
+
+  int width() const { return w; }
+  int height() const { return h; }
+  int stride() const { return s; }  // Distance between rows, in floats
+
+  // Valid for -1 <= x <= width, -1 <= y <= height
+  float& operator()(int x, int y) { return data[(y + 1) * s + x + 1]; }
+  float operator()(int x, int y) const { return data[(y + 1) * s + x + 1]; }
+
+  // Pointer to cell (0, y); row(y)[-1] and row(y)[width] are ghost cells
+  float* row(int y) { return &data[(y + 1) * s + 1]; }
+  const float* row(int y) const { return &data[(y + 1) * s + 1]; }
+
+  void fill(float value) { std::fill(data.begin(), data.end(), value); }
+
+  // Copy the periodic images of the edges (and corners) into the ghost border
+  void fillGhosts() {
+    for (int y = 0; y < h; ++y) {
+      float* r = row(y);
+      r[-1] = r[w - 1];
+      r[w] = r[0];
+    }
+    std::copy(row(h - 1) - 1, row(h - 1) + w + 1, row(-1) - 1);
+    std::copy(row(0) - 1, row(0) + w + 1, row(h) - 1);
+  }
+
+  void swap(Field& other) {
+    std::swap(w, other.w);
+    std::swap(h, other.h);
+    std::swap(s, other.s);
+    data.swap(other.data);
+  }
+
+private:
+  int w, h, s;
+  std::vector<float> data;
+};
+
+#endif
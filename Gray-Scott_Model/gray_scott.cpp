@@ -0,0 +1,77 @@
+#include "gray_scott.hpp"
+#include <algorithm>
+#include <random>
+
+void initializeGrid(Field& u, Field& v, unsigned seed) {
+  int width = u.width();
+  int height = u.height();
+
+  // Initialize the grid with default values
+  u.fill(1.0f); // Start with U at maximum concentration
+  v.fill(0.0f); // V is initially 0
+
+  // Seed multiple random blobs of U and V across the grid
+  int numBlobs = 10; // Number of random blobs
+  int blobSize = 10; // Size of each blob (radius)
+
+  // Random number generator initialization; local, so grids can be set up concurrently
+  std::mt19937 rng(seed);
+  auto uniform = [&rng]() { return static_cast<float>(rng() - rng.min()) / static_cast<float>(rng.max() - rng.min()); };
+
+  for (int i = 0; i < numBlobs; ++i) {
+    // Generate random position for each blob
+    int centerX = static_cast<int>(rng() % width);
+    int centerY = static_cast<int>(rng() % height);
+
+    // Fill a circular region around the center with random values for U and V
+    for (int y = -blobSize; y <= blobSize; ++y) {
+      for (int x = -blobSize; x <= blobSize; ++x) {
+        int posX = (centerX + x + width) % width;
+        int posY = (centerY + y + height) % height;
+
+        // Check if (x, y) is within the blob radius
+        if (x * x + y * y <= blobSize * blobSize) {
+          u(posX, posY) = 0.5f + uniform() * 0.5f; // Random variation in U
+          v(posX, posY) = 0.25f + uniform() * 0.5f; // Random variation in V
+        }
+      }
+    }
+  }
+}
+
+
+void updateGrid(Grid& grid) {
+  int width = grid.u.width();
+  int height = grid.u.height();
+  const Params& p = grid.params;
+  grid.u.fillGhosts();
+  grid.v.fillGhosts();
+
+  for (int y = 0; y < height; ++y) {
+    const float* u = grid.u.row(y);
+    const float* v = grid.v.row(y);
+    const float* uNorth = grid.u.row(y - 1);
+    const float* uSouth = grid.u.row(y + 1);
+    const float* vNorth = grid.v.row(y - 1);
+    const float* vSouth = grid.v.row(y + 1);
+    float* newU = grid.nextU.row(y);
+    float* newV = grid.nextV.row(y);
+
+    for (int x = 0; x < width; ++x) {
+      float lapU = laplacian(uNorth, u, uSouth, x);
+      float lapV = laplacian(vNorth, v, vSouth, x);
+
+      // Gray-Scott's model equations
+      float uvv = u[x] * v[x] * v[x];
+      newU[x] = u[x] + (p.du * lapU - uvv + p.feed * (1.0f - u[x])) * p.deltaT;
+      newV[x] = v[x] + (p.dv * lapV + uvv - (p.feed + p.kill) * v[x]) * p.deltaT;
+
+      // Clamp values between 0 and 1
+      newU[x] = std::min(1.0f, std::max(0.0f, newU[x]));
+      newV[x] = std::min(1.0f, std::max(0.0f, newV[x]));
+    }
+  }
+
+  grid.u.swap(grid.nextU);
+  grid.v.swap(grid.nextV);
+}
@@ -0,0 +1,55 @@
+#ifndef GRAY_SCOTT_HPP
+#define GRAY_SCOTT_HPP
+#include "field.hpp"
+
+// Parameters for the Gray-Scott model
+struct Params {
+  int width = 400;       // Width of the simulation grid
+  int height = 400;      // Height of the simulation grid
+  float du = 0.916f;     // Diffusion rate for U
+  float dv = 0.18f;      // Diffusion rate for V
+  float feed = 0.095f;   // Feed rate of U
+  float kill = 0.06f;    // Kill rate of V
+  float deltaT = 1.0f;   // Time step
+};
+
+const int ITERATIONS_PER_FRAME = 10; // Number of iterations per frame
+
+// The two concentration fields plus the buffers the next step is written to.
+// Every step swaps the pairs, so nothing is allocated after construction.
+// Each grid carries its own parameters, so independent grids share no state.
+struct Grid {
+  Params params;
+  Field u, v;
+  Field nextU, nextV;
+
+  explicit Grid(const Params& params)
+      : params(params),
+        u(params.width, params.height, 1.0f), v(params.width, params.height, 0.0f),
+        nextU(params.width, params.height), nextV(params.width, params.height) {}
+};
+
+// Initialize the grid with random blobs of U and V, placed by a generator seeded with `seed`
+void initializeGrid(Field& u, Field& v, unsigned seed);
+
+//  Function to calculate the Laplacian of a grid point.
+//  north, center and south point at cell x of rows y - 1, y and y + 1; the ghost
+//  cells of the field supply the periodic neighbors at the edges.
+inline float laplacian(const float* north, const float* center, const float* south, int x) {
+  float result = 0.0f;
+  result += center[x] * -1.0f;
+  result += south[x] * 0.2f;
+  result += north[x] * 0.2f;
+  result += center[x + 1] * 0.2f;
+  result += center[x - 1] * 0.2f;
+  result += south[x + 1] * 0.05f;
+  result += south[x - 1] * 0.05f;
+  result += north[x + 1] * 0.05f;
+  result += north[x - 1] * 0.05f;
+  return result;
+}
+
+// Update grid with Gray-Scott model (scalar reference implementation)
+void updateGrid(Grid& grid);
+
+#endif
@@ -0,0 +1,196 @@
+#include "imex.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+  const float SAFETY = 0.9f;      // Aim a bit below the tolerance when resizing the step
+  const float MAX_GROWTH = 2.0f;  // Largest step increase after an accepted step
+  const float MIN_SHRINK = 0.2f;  // Largest step decrease after a rejected one
+  const float MIN_STEP = 1e-4f;   // Steps this small are accepted whatever the estimate
+  const int LANE_BLOCK = 64;      // Sequences transformed together; keeps the FFT's working set in L2
+
+  // Factor to resize a step whose estimated error was `error`; the method is first order,
+  // so the error scales with the square of the step
+  float resizeFactor(float error, float tolerance) {
+    if (!(error > 0.0f)) return error == 0.0f ? MAX_GROWTH : MIN_SHRINK; // 0 or nan
+    return std::min(MAX_GROWTH, std::max(MIN_SHRINK, SAFETY * std::sqrt(tolerance / error)));
+  }
+
+  // Transform a row-major field of `lanes` columns along its columns, LANE_BLOCK columns per task
+  void transformLanes(const Fft& fft, float* re, float* im, int lanes, bool inverse) {
+    int blocks = (lanes + LANE_BLOCK - 1) / LANE_BLOCK;
+    #pragma omp parallel for schedule(static)
+    for (int block = 0; block < blocks; ++block) {
+      int first = block * LANE_BLOCK;
+      int count = std::min(LANE_BLOCK, lanes - first);
+      if (inverse) fft.inverse(re + first, im + first, count, lanes);
+      else fft.forward(re + first, im + first, count, lanes);
+    }
+  }
+
+  // out = transpose of the rows x columns field in, for both parts, in 32 x 32 blocks
+  void transpose(const float* inRe, const float* inIm, float* outRe, float* outIm, int columns, int rows) {
+    const int block = 32;
+    #pragma omp parallel for schedule(static)
+    for (int y0 = 0; y0 < rows; y0 += block) {
+      for (int x0 = 0; x0 < columns; x0 += block) {
+        int yEnd = std::min(rows, y0 + block);
+        int xEnd = std::min(columns, x0 + block);
+        for (int x = x0; x < xEnd; ++x) {
+          for (int y = y0; y < yEnd; ++y) {
+            outRe[x * rows + y] = inRe[y * columns + x];
+            outIm[x * rows + y] = inIm[y * columns + x];
+          }
+        }
+      }
+    }
+  }
+}
+
+imex::Solver::Solver(const Params& params, float tolerance)
+    : width(params.width), height(params.height), tolerance(tolerance),
+      dt(params.deltaT), previousDt(0.0f),
+      rowFft(params.width), columnFft(params.height),
+      cosX(params.width), cosY(params.height),
+      re(params.width * params.height), im(params.width * params.height),
+      spectrumRe(params.width * params.height), spectrumIm(params.width * params.height),
+      changeU(params.width * params.height), changeV(params.width * params.height) {
+  const double pi = 3.14159265358979323846;
+  for (int k = 0; k < width; ++k) cosX[k] = static_cast<float>(std::cos(2.0 * pi * k / width));
+  for (int k = 0; k < height; ++k) cosY[k] = static_cast<float>(std::cos(2.0 * pi * k / height));
+}
+
+void imex::Solver::solve(Grid& grid, float h) {
+  const Params& p = grid.params;
+  const float normalization = 1.0f / (static_cast<float>(width) * height);
+
+  // Explicit part of the step, packed as u + i v
+  #pragma omp parallel for schedule(static)
+  for (int y = 0; y < height; ++y) {
+    const float* u = grid.u.row(y);
+    const float* v = grid.v.row(y);
+    float* outRe = &re[y * width];
+    float* outIm = &im[y * width];
+    for (int x = 0; x < width; ++x) {
+      float uvv = u[x] * v[x] * v[x];
+      outRe[x] = u[x] + h * (p.feed - uvv);
+      outIm[x] = v[x] + h * uvv;
+    }
+  }
+
+  // Transform along y with the columns as lanes, then along x with the rows of the transposed field as lanes
+  transformLanes(columnFft, &re[0], &im[0], width, false);
+  transpose(&re[0], &im[0], &spectrumRe[0], &spectrumIm[0], width, height);
+  transformLanes(rowFft, &spectrumRe[0], &spectrumIm[0], height, false);
+
+  // Wave numbers k and -k are needed together to unpack u and v, so each pair is solved at once.
+  // Columns 0 and width / 2 are their own mirror; their pairs lie within the column.
+  #pragma omp parallel for schedule(static)
+  for (int kx = 0; kx <= width / 2; ++kx) {
+    int mirrorX = (width - kx) % width;
+    float* aRe = &spectrumRe[kx * height];
+    float* aIm = &spectrumIm[kx * height];
+    float* bRe = &spectrumRe[mirrorX * height];
+    float* bIm = &spectrumIm[mirrorX * height];
+
+    for (int ky = 0; ky < height; ++ky) {
+      int mirrorY = (height - ky) % height;
+      if (mirrorX == kx && mirrorY < ky) continue; // Already done as the mirror of an earlier one
+
+      // Eigenvalue of the 9-point Laplacian for the wave number (kx, ky); even in both
+      float lambda = -1.0f + 0.4f * (cosX[kx] + cosY[ky]) + 0.2f * cosX[kx] * cosY[ky];
+      float solveU = 1.0f / (1.0f + h * p.feed - h * p.du * lambda);
+      float solveV = 1.0f / (1.0f + h * (p.feed + p.kill) - h * p.dv * lambda);
+
+      // With Z = FFT(u + i v): U(k) = (Z(k) + conj Z(-k)) / 2 and V(k) = (Z(k) - conj Z(-k)) / 2i,
+      // so the solved solveU U(k) + i solveV V(k) is same Z(k) + conjugate conj Z(-k)
+      float same = 0.5f * (solveU + solveV) * normalization;
+      float conjugate = 0.5f * (solveU - solveV) * normalization;
+      float zRe = aRe[ky], zIm = aIm[ky];
+      float mirrorRe = bRe[mirrorY], mirrorIm = bIm[mirrorY];
+      aRe[ky] = same * zRe + conjugate * mirrorRe;
+      aIm[ky] = same * zIm - conjugate * mirrorIm;
+      bRe[mirrorY] = same * mirrorRe + conjugate * zRe;
+      bIm[mirrorY] = same * mirrorIm - conjugate * zIm;
+    }
+  }
+
+  // And back; the real part is u, the imaginary part v
+  transformLanes(rowFft, &spectrumRe[0], &spectrumIm[0], height, true);
+  transpose(&spectrumRe[0], &spectrumIm[0], &re[0], &im[0], height, width);
+  transformLanes(columnFft, &re[0], &im[0], width, true);
+
+  #pragma omp parallel for schedule(static)
+  for (int y = 0; y < height; ++y) {
+    std::copy(&re[y * width], &re[y * width] + width, grid.nextU.row(y));
+    std::copy(&im[y * width], &im[y * width] + width, grid.nextV.row(y));
+  }
+}
+
+float imex::Solver::step(Grid& grid, float maxStep) {
+  bool retried = false;
+  while (true) {
+    float h = std::min(dt, maxStep);
+    solve(grid, h);
+
+    // Local error ~ h^2 u'' / 2, with u'' from the increments of this step and the last one
+    float error = 0.0f;
+    if (previousDt > 0.0f) {
+      float ratio = h / previousDt;
+      float weight = h / (h + previousDt);
+      #pragma omp parallel for schedule(static) reduction(max : error)
+      for (int y = 0; y < height; ++y) {
+        const float* u = grid.u.row(y);
+        const float* v = grid.v.row(y);
+        const float* newU = grid.nextU.row(y);
+        const float* newV = grid.nextV.row(y);
+        const float* lastU = &changeU[y * width];
+        const float* lastV = &changeV[y * width];
+        for (int x = 0; x < width; ++x) {
+          float errorU = std::fabs((newU[x] - u[x]) - ratio * lastU[x]);
+          float errorV = std::fabs((newV[x] - v[x]) - ratio * lastV[x]);
+          error = std::max(error, weight * std::max(errorU, errorV));
+        }
+      }
+    }
+
+    float factor = resizeFactor(error, tolerance);
+    if (retried) factor = std::min(factor, 1.0f); // Do not grow right after a rejection
+    if (error <= tolerance || h <= MIN_STEP) {
+      for (int y = 0; y < height; ++y) {
+        const float* u = grid.u.row(y);
+        const float* v = grid.v.row(y);
+        const float* newU = grid.nextU.row(y);
+        const float* newV = grid.nextV.row(y);
+        for (int x = 0; x < width; ++x) {
+          changeU[y * width + x] = newU[x] - u[x];
+          changeV[y * width + x] = newV[x] - v[x];
+        }
+      }
+      grid.u.swap(grid.nextU);
+      grid.v.swap(grid.nextV);
+      ++accepted;
+
+      // The first step has no estimate, and a step cut short by maxStep says nothing about growing
+      if (previousDt > 0.0f && (h == dt || factor < 1.0f)) dt = std::max(MIN_STEP, h * factor);
+      previousDt = h;
+      return h;
+    }
+
+    ++rejected;
+    retried = true;
+    dt = std::max(MIN_STEP, h * factor);
+  }
+}
+
+void imex::Solver::advance(Grid& grid, double time) {
+  while (time > 0.0) {
+    // Split what is left evenly instead of ending on a sliver
+    float maxStep = static_cast<float>(time);
+    if (dt < time && 2.0 * dt > time) maxStep = static_cast<float>(time / 2.0);
+    float h = step(grid, maxStep);
+    time -= h;
+    if (time < 1e-6 * h) break; // Rounding of the float steps
+  }
+}
@@ -0,0 +1,73 @@
+#ifndef IMEX_HPP
+#define IMEX_HPP
+#include <vector>
+#include "fft.hpp"
+#include "gray_scott.hpp"
+
+/* Semi-implicit (IMEX) Gray-Scott integration with an adaptive time step.
+ *
+ * The explicit step is only stable for deltaT * D < 1 / 1.6 with the 9-point
+ * Laplacian, which is why updateGrid clamps the fields and why raising Du
+ * forces smaller steps. Here one step of size h is
+ *
+ *   (1 + h F - h Du L) u' = u + h (F - u v^2)
+ *   (1 + h (F + k) - h Dv L) v' = v + h u v^2
+ *
+ * i.e. the linear terms (diffusion, feed and kill) are backward Euler and the
+ * u v^2 reaction forward Euler. L is the same 9-point stencil as laplacian();
+ * on the periodic grid it is diagonal in Fourier space, so each solve is a 2D
+ * FFT, a division and an inverse FFT. U and V are packed into the real and
+ * imaginary parts of one complex field, so a solve costs one forward and one
+ * inverse complex transform.
+ *
+ * The linear part is stable for any h. The step is chosen by error control: the
+ * local error is estimated from the change of the increment between
+ * consecutive steps (h^2 u'' / 2), steps whose estimate exceeds the tolerance
+ * are redone with a smaller h, and h grows by up to 2x per step while the
+ * solution is smooth in time. Nothing is clamped.
+ *
+ * A step costs about 25 explicit steps' worth of arithmetic, so this wins
+ * when the accepted h is large: high diffusion rates, and the slow approach
+ * to a stationary pattern.
+ */
+namespace imex {
+
+  // Maximum local error per step, in concentration units. The explicit step with
+  // deltaT = 1 makes errors of this order while the patterns form.
+  const float DEFAULT_TOLERANCE = 1e-2f;
+
+  class Solver {
+  public:
+    // Solver for grids of params.width x params.height; the first step tries params.deltaT
+    explicit Solver(const Params& params, float tolerance = DEFAULT_TOLERANCE);
+
+    // Take one step of at most maxStep time units and return its size.
+    // Rejected attempts are retried with a smaller step before returning.
+    float step(Grid& grid, float maxStep);
+
+    // Advance the grid by `time` time units, landing exactly on it
+    void advance(Grid& grid, double time);
+
+    float timeStep() const { return dt; } // Size the next step will try
+    long acceptedSteps() const { return accepted; }
+    long rejectedSteps() const { return rejected; }
+
+  private:
+    // grid.nextU / grid.nextV = one IMEX step of size h from grid.u / grid.v
+    void solve(Grid& grid, float h);
+
+    int width, height;
+    float tolerance;
+    float dt;            // Next step size to try
+    float previousDt;    // Size of the last accepted step, 0 before the first
+    long accepted = 0, rejected = 0;
+
+    Fft rowFft, columnFft;
+    std::vector<float> cosX, cosY;          // cos(2 pi k / n) for every wave number
+    std::vector<float> re, im;              // Packed u + i v, row by row
+    std::vector<float> spectrumRe, spectrumIm; // Its transform, column by column (index kx * height + ky)
+    std::vector<float> changeU, changeV;    // Increment of the last accepted step
+  };
+}
+
+#endif
@@ -11,116 +11,387 @@
 
 #include <SFML/Graphics.hpp>
 #include <vector>
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <ctime>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "gray_scott.hpp"
+#include "stencil_kernel.hpp"
+#include "temporal_blocking.hpp"
+#include "imex.hpp"
+#include "colormap.hpp"
+#include "checkpoint.hpp"
+#include "sweep.hpp"
 
-// Parameters for the Gray-Scott model
-const int WIDTH = 400;         // Width of the simulation grid
-const int HEIGHT = 400;        // Height of the simulation grid
-const float DU = 0.916f;        // Diffusion rate for U
-const float DV = 0.18f;        // Diffusion rate for V
-const float FEED = 0.095f;     // Feed rate of U
-const float KILL = 0.06f;      // Kill rate of V
-const float DELTA_T = 1.0f;    // Time step
-const int ITERATIONS_PER_FRAME = 10; // Number of iterations per frame
-
-// Initialize the grid with random blobs of U and V
-void initializeGrid(std::vector<std::vector<float>>& u, std::vector<std::vector<float>>& v) {
-  // Initialize the grid with default values
-  for (int y = 0; y < HEIGHT; ++y) {
-    for (int x = 0; x < WIDTH; ++x) {
-      u[y][x] = 1.0f; // Start with U at maximum concentration
-      v[y][x] = 0.0f; // V is initially 0
+// Write both fields as raw floats: int32 width, int32 height, then U and V row by row
+bool writeRawFrame(const std::string& path, const Field& u, const Field& v) {
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) return false;
+
+  int width = u.width();
+  int height = u.height();
+  int header[2] = {width, height};
+  bool ok = std::fwrite(header, sizeof(int), 2, file) == 2;
+  for (int y = 0; y < height && ok; ++y) ok = std::fwrite(u.row(y), sizeof(float), width, file) == static_cast<size_t>(width);
+  for (int y = 0; y < height && ok; ++y) ok = std::fwrite(v.row(y), sizeof(float), width, file) == static_cast<size_t>(width);
+  return std::fclose(file) == 0 && ok;
+}
+
+// Command line options shared by all modes
+struct Options {
+  Params params;
+  bool sizeGiven = false;
+  unsigned seed = static_cast<unsigned>(std::time(0));
+  unsigned threads = 0;
+  bool raw = false;
+  bool blocked = false;
+  bool imex = false;
+  float tolerance = imex::DEFAULT_TOLERANCE;
+  std::string checkpointPath;  // Where checkpoints are written; none if empty
+  long checkpointEvery = 0;    // Steps between checkpoints; 0 = only at the end
+  std::string restartPath;     // Checkpoint to continue from
+  std::vector<std::string> modelFlags; // Size, parameter and seed flags given, which a checkpoint replaces
+  std::vector<std::string> positional;
+};
+
+// Parse argv[first..]: model parameters, mode flags and positional arguments
+bool parseOptions(int argc, char* argv[], int first, Options& options) {
+  const char* const MODEL_FLAGS[] = {"--size", "--width", "--height", "--du", "--dv", "--feed", "--kill", "--dt", "--seed"};
+  for (int i = first; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    for (const char* flag : MODEL_FLAGS) {
+      if (arg == flag) options.modelFlags.push_back(arg);
+    }
+
+    if (arg == "--raw") options.raw = true;
+    else if (arg == "--blocked") options.blocked = true;
+    else if (arg == "--imex") options.imex = true;
+    else if (arg == "--tolerance" && hasValue) options.tolerance = std::strtof(argv[++i], nullptr);
+    else if (arg == "--size" && hasValue) {
+      options.params.width = options.params.height = std::atoi(argv[++i]);
+      options.sizeGiven = true;
+    }
+    else if (arg == "--width" && hasValue) { options.params.width = std::atoi(argv[++i]); options.sizeGiven = true; }
+    else if (arg == "--height" && hasValue) { options.params.height = std::atoi(argv[++i]); options.sizeGiven = true; }
+    else if (arg == "--du" && hasValue) options.params.du = std::strtof(argv[++i], nullptr);
+    else if (arg == "--dv" && hasValue) options.params.dv = std::strtof(argv[++i], nullptr);
+    else if (arg == "--feed" && hasValue) options.params.feed = std::strtof(argv[++i], nullptr);
+    else if (arg == "--kill" && hasValue) options.params.kill = std::strtof(argv[++i], nullptr);
+    else if (arg == "--dt" && hasValue) options.params.deltaT = std::strtof(argv[++i], nullptr);
+    else if (arg == "--seed" && hasValue) options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+    else if (arg == "--threads" && hasValue) options.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+    else if (arg == "--checkpoint" && hasValue) options.checkpointPath = argv[++i];
+    else if (arg == "--checkpoint-every" && hasValue) options.checkpointEvery = std::atol(argv[++i]);
+    else if (arg == "--restart" && hasValue) options.restartPath = argv[++i];
+    else if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+      std::cerr << "Unknown or incomplete option " << arg << std::endl;
+      return false;
     }
+    else options.positional.push_back(arg);
+  }
+
+  if (options.params.width < 1 || options.params.height < 1) {
+    std::cerr << "Grid size must be positive" << std::endl;
+    return false;
+  }
+  if (options.imex && options.blocked) {
+    std::cerr << "--imex and --blocked cannot be combined" << std::endl;
+    return false;
+  }
+  if (!options.restartPath.empty() && !options.modelFlags.empty()) {
+    // The checkpoint fixes the grid, the model and the seed; silently dropping these would change the run
+    std::cerr << "--restart takes the size, parameters and seed from the checkpoint; remove";
+    for (const std::string& flag : options.modelFlags) std::cerr << " " << flag;
+    std::cerr << std::endl;
+    return false;
+  }
+  if (options.checkpointEvery > 0 && options.checkpointPath.empty()) {
+    std::cerr << "--checkpoint-every needs --checkpoint PATH" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Grid a run starts from: the checkpoint given with --restart, which also sets
+// the parameters, seed and step count, or fresh blobs from the options.
+std::unique_ptr<Grid> startGrid(const Options& options, unsigned& seed, long& step) {
+  std::unique_ptr<Grid> grid;
+  if (options.restartPath.empty()) {
+    seed = options.seed;
+    step = 0;
+    grid.reset(new Grid(options.params));
+    initializeGrid(grid->u, grid->v, seed);
+  } else {
+    MappedCheckpoint checkpoint;
+    if (!checkpoint.open(options.restartPath)) return grid;
+    seed = checkpoint.seed();
+    step = static_cast<long>(checkpoint.step());
+    grid.reset(new Grid(checkpoint.params()));
+    checkpoint.load(*grid);
+    std::cout << "Restarting from " << options.restartPath << " at step " << step << std::endl;
   }
+  std::cout << "Seed " << seed << " (rerun with --seed " << seed << ")" << std::endl;
+  return grid;
+}
 
-  // Seed multiple random blobs of U and V across the grid
-  int numBlobs = 10; // Number of random blobs
-  int blobSize = 10; // Size of each blob (radius)
+// Run without a window: advance to step `iterations` as fast as possible and
+// dump the fields every `dumpEvery` steps (0 = only the final state).
+// --blocked uses temporal blocking between dumps. With --imex the counts are
+// in units of deltaT of model time, and the solver picks its own steps.
+// With --checkpoint, the state is saved in the background every
+// --checkpoint-every steps and at the end; --restart continues such a run
+// (with the size, parameters and seed of the checkpoint, so those flags are rejected).
+int runHeadless(const Options& options, long iterations, long dumpEvery, const std::string& prefix) {
+  unsigned seed;
+  long step;
+  std::unique_ptr<Grid> start = startGrid(options, seed, step);
+  if (!start) return 1;
+  Grid& grid = *start;
+  const Params& params = grid.params;
+  bool raw = options.raw;
+  long firstStep = step;
 
-  // Random number generator initialization
-  std::srand(static_cast<unsigned>(std::time(0)));
+  std::unique_ptr<CheckpointWriter> checkpoints;
+  if (!options.checkpointPath.empty()) checkpoints.reset(new CheckpointWriter(options.checkpointPath));
+  long checkpointEvery = options.checkpointEvery;
 
-  for (int i = 0; i < numBlobs; ++i) {
-    // Generate random position for each blob
-    int centerX = std::rand() % WIDTH;
-    int centerY = std::rand() % HEIGHT;
+  Colormap colormap;
+  std::vector<sf::Uint8> pixels(params.width * params.height * 4);
+  sf::Image image;
+  double simulationSeconds = 0.0;
+  int frame = 0;
 
-    // Fill a circular region around the center with random values for U and V
-    for (int y = -blobSize; y <= blobSize; ++y) {
-      for (int x = -blobSize; x <= blobSize; ++x) {
-        int posX = (centerX + x + WIDTH) % WIDTH;
-        int posY = (centerY + y + HEIGHT) % HEIGHT;
+  auto dump = [&](long step) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "_%06d_step%ld.%s", frame++, step, raw ? "raw" : "png");
+    std::string path = prefix + name;
+    bool ok;
+    if (raw) {
+      ok = writeRawFrame(path, grid.u, grid.v);
+    } else {
+      colormap.convert(grid.u, grid.v, pixels.data());
+      image.create(params.width, params.height, pixels.data());
+      ok = image.saveToFile(path);
+    }
+    if (!ok) std::cerr << "Could not write " << path << std::endl;
+  };
 
-        // Check if (x, y) is within the blob radius
-        if (x * x + y * y <= blobSize * blobSize) {
-          u[posY][posX] = 0.5f + static_cast<float>(std::rand()) / RAND_MAX * 0.5f; // Random variation in U
-          v[posY][posX] = 0.25f + static_cast<float>(std::rand()) / RAND_MAX * 0.5f; // Random variation in V
-        }
-      }
+  RowKernel kernel = stencil::select();
+  std::unique_ptr<imex::Solver> solver; // Its FFT buffers are several times the size of the fields
+  if (options.imex) solver.reset(new imex::Solver(params, options.tolerance));
+  auto startTime = std::chrono::steady_clock::now();
+  while (step < iterations) {
+    // Run up to the next dump or checkpoint in one batch
+    long batch = iterations - step;
+    if (dumpEvery > 0) batch = std::min(batch, dumpEvery - step % dumpEvery);
+    if (checkpointEvery > 0) batch = std::min(batch, checkpointEvery - step % checkpointEvery);
+
+    auto batchStart = std::chrono::steady_clock::now();
+    if (options.imex) {
+      solver->advance(grid, batch * static_cast<double>(params.deltaT));
+    } else if (options.blocked) {
+      temporal::advance(grid, static_cast<int>(batch), kernel);
+    } else {
+      for (long i = 0; i < batch; ++i) stencil::step(grid, kernel);
     }
+    simulationSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStart).count();
+    step += batch;
+
+    if ((dumpEvery > 0 && step % dumpEvery == 0) || step == iterations) {
+      dump(step);
+    }
+    if (checkpoints && ((checkpointEvery > 0 && step % checkpointEvery == 0) || step == iterations)) {
+      checkpoints->save(grid, seed, step);
+    }
+  }
+  bool checkpointsOk = !checkpoints || checkpoints->finish();
+  double totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+  long done = step - firstStep;
+  std::cout << done << " iterations on " << params.width << "x" << params.height << " in " << totalSeconds << " s";
+  // Nothing to time with zero iterations or a restart from a checkpoint already at the target
+  if (done > 0 && simulationSeconds > 0 && totalSeconds > 0) {
+    std::cout << ": " << done / simulationSeconds << " it/s (solver only), "
+              << done / totalSeconds << " it/s (with " << frame << " dumps)";
+  }
+  std::cout << std::endl;
+  if (options.imex) {
+    std::cout << "IMEX: " << solver->acceptedSteps() << " steps (" << solver->rejectedSteps()
+              << " rejected) for t = " << done * static_cast<double>(params.deltaT)
+              << ", next step " << solver->timeStep() << std::endl;
   }
+  return checkpointsOk ? 0 : 1;
 }
 
+// Run a (feed, kill) sweep and write the summary table
+int runSweepMode(const Options& options) {
+  const std::vector<std::string>& args = options.positional;
+  if (args.size() < 6) {
+    std::cerr << "Usage: --sweep FEED_MIN FEED_MAX FEED_STEPS KILL_MIN KILL_MAX KILL_STEPS [STEPS] [OUTPUT]" << std::endl;
+    return 1;
+  }
 
-//  Function to calculate the Laplacian of a grid point
-float laplacian(const std::vector<std::vector<float>>& grid, int x, int y) {
-  float result = 0.0f;
-  result += grid[y][x] * -1.0f;
-  result += grid[(y + 1) % HEIGHT][x] * 0.2f;
-  result += grid[(y - 1 + HEIGHT) % HEIGHT][x] * 0.2f;
-  result += grid[y][(x + 1) % WIDTH] * 0.2f;
-  result += grid[y][(x - 1 + WIDTH) % WIDTH] * 0.2f;
-  result += grid[(y + 1) % HEIGHT][(x + 1) % WIDTH] * 0.05f;
-  result += grid[(y + 1) % HEIGHT][(x - 1 + WIDTH) % WIDTH] * 0.05f;
-  result += grid[(y - 1 + HEIGHT) % HEIGHT][(x + 1) % WIDTH] * 0.05f;
-  result += grid[(y - 1 + HEIGHT) % HEIGHT][(x - 1 + WIDTH) % WIDTH] * 0.05f;
-  return result;
+  SweepConfig config;
+  config.base = options.params;
+  if (!options.sizeGiven) config.base.width = config.base.height = 128; // Small grids, many points
+  config.feedMin = std::strtof(args[0].c_str(), nullptr);
+  config.feedMax = std::strtof(args[1].c_str(), nullptr);
+  config.feedSteps = std::max(1, std::atoi(args[2].c_str()));
+  config.killMin = std::strtof(args[3].c_str(), nullptr);
+  config.killMax = std::strtof(args[4].c_str(), nullptr);
+  config.killSteps = std::max(1, std::atoi(args[5].c_str()));
+  if (args.size() > 6) config.steps = std::atoi(args[6].c_str());
+  std::string output = args.size() > 7 ? args[7] : "sweep.dat";
+  config.seed = options.seed;
+  config.threads = options.threads;
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<SweepResult> results = runSweep(config);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if (!writeSweepTable(output, results)) {
+    std::cerr << "Could not write " << output << std::endl;
+    return 1;
+  }
+  std::cout << results.size() << " points of " << config.steps << " steps on " << config.base.width << "x"
+            << config.base.height << " in " << seconds << " s, written to " << output << std::endl;
+  return 0;
 }
 
-// Update grid with Gray-Scott model
-void updateGrid(std::vector<std::vector<float>>& u, std::vector<std::vector<float>>& v) {
-  std::vector<std::vector<float>> newU = u;
-  std::vector<std::vector<float>> newV = v;
+// Time the scalar updateGrid against the tiled and temporally blocked kernels on a size x size grid
+// and check that they produce the same fields.
+int runBenchmark(Params params, unsigned seed, int size, int steps) {
+  params.width = params.height = size;
+  Grid reference(params);
+  initializeGrid(reference.u, reference.v, seed);
+  Grid tiledScalar = reference;
+  Grid tiledFast = reference;
+  Grid blocked = reference;
+  RowKernel fastKernel = stencil::select();
+
+  auto time = [&](Grid& grid, void (*step)(Grid&, RowKernel), RowKernel kernel) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) step(grid, kernel);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+  auto referenceStep = [](Grid& grid, RowKernel) { updateGrid(grid); };
+  auto tiledStep = [](Grid& grid, RowKernel kernel) { stencil::step(grid, kernel); };
+  auto mismatches = [&](const Grid& grid) {
+    long count = 0;
+    for (int y = 0; y < size; ++y) {
+      for (int x = 0; x < size; ++x) {
+        count += grid.u(x, y) != reference.u(x, y);
+        count += grid.v(x, y) != reference.v(x, y);
+      }
+    }
+    return count;
+  };
+
+  double cellUpdates = static_cast<double>(size) * size * steps;
+  double referenceSeconds = time(reference, referenceStep, nullptr);
+  double scalarSeconds = time(tiledScalar, tiledStep, &stencil::rowScalar);
+  double fastSeconds = time(tiledFast, tiledStep, fastKernel);
+
+  auto start = std::chrono::steady_clock::now();
+  temporal::advance(blocked, steps, fastKernel);
+  double blockedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << size << "x" << size << ", " << steps << " steps" << std::endl;
+  std::cout << "  updateGrid: " << cellUpdates / referenceSeconds << " cell updates/s" << std::endl;
+  std::cout << "  tiled scalar: " << cellUpdates / scalarSeconds << " cell updates/s ("
+            << referenceSeconds / scalarSeconds << "x, " << mismatches(tiledScalar) << " mismatches)" << std::endl;
+  std::cout << "  tiled " << stencil::name(fastKernel) << ": " << cellUpdates / fastSeconds << " cell updates/s ("
+            << referenceSeconds / fastSeconds << "x, " << mismatches(tiledFast) << " mismatches)" << std::endl;
+  std::cout << "  temporal blocking (" << temporal::DEFAULT_DEPTH << " steps/sweep): " << cellUpdates / blockedSeconds << " cell updates/s ("
+            << referenceSeconds / blockedSeconds << "x, " << mismatches(blocked) << " mismatches)" << std::endl;
+
+  // Colormap stage, one conversion per step to compare with the step time
+  Colormap scalarColormap(&colormap::rowScalar);
+  Colormap fastColormap;
+  std::vector<sf::Uint8> scalarPixels(size * size * 4), fastPixels(size * size * 4);
+  auto timeColormap = [&](const Colormap& map, std::vector<sf::Uint8>& pixels) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) map.convert(reference.u, reference.v, pixels.data());
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+  double scalarColormapSeconds = timeColormap(scalarColormap, scalarPixels);
+  double fastColormapSeconds = timeColormap(fastColormap, fastPixels);
+  std::cout << "  colormap scalar: " << cellUpdates / scalarColormapSeconds << " pixels/s" << std::endl;
+  std::cout << "  colormap " << colormap::name(fastColormap.converter()) << ": " << cellUpdates / fastColormapSeconds << " pixels/s ("
+            << scalarColormapSeconds / fastColormapSeconds << "x, " << (scalarPixels == fastPixels ? "same" : "different")
+            << " pixels, " << 100.0 * fastColormapSeconds / fastSeconds << "% of a tiled step)" << std::endl;
+  return 0;
+}
 
-  for (int y = 0; y < HEIGHT; ++y) {
-    for (int x = 0; x < WIDTH; ++x) {
-      float lapU = laplacian(u, x, y);
-      float lapV = laplacian(v, x, y);
+int main(int argc, char* argv[]) {
+  // Usage:
+  //   ./gray_scott [OPTIONS]
+  //   ./gray_scott --headless ITERATIONS [DUMP_EVERY] [PREFIX] [--raw] [--blocked] [CHECKPOINTS] [OPTIONS]
+  //   ./gray_scott --benchmark [SIZE] [STEPS] [OPTIONS]
+  //   ./gray_scott --sweep FEED_MIN FEED_MAX FEED_STEPS KILL_MIN KILL_MAX KILL_STEPS [STEPS] [OUTPUT] [OPTIONS]
+  // OPTIONS: --size N, --width N, --height N, --du X, --dv X, --feed X, --kill X, --dt X, --seed N, --threads N,
+  //          --imex [--tolerance X] (implicit diffusion with adaptive steps, headless and window modes)
+  // CHECKPOINTS: --checkpoint PATH [--checkpoint-every N], --restart PATH (headless and window modes)
+  std::string mode = argc > 1 ? argv[1] : "";
+  bool hasMode = mode == "--headless" || mode == "--benchmark" || mode == "--sweep";
 
-      // Gray-Scott's model equations
-      float uvv = u[y][x] * v[y][x] * v[y][x];
-      newU[y][x] = u[y][x] + (DU * lapU - uvv + FEED * (1.0f - u[y][x])) * DELTA_T;
-      newV[y][x] = v[y][x] + (DV * lapV + uvv - (FEED + KILL) * v[y][x]) * DELTA_T;
+  Options options;
+  if (!parseOptions(argc, argv, hasMode ? 2 : 1, options)) return 1;
+  const std::vector<std::string>& args = options.positional;
 
-      // Clamp values between 0 and 1
-      newU[y][x] = std::min(1.0f, std::max(0.0f, newU[y][x]));
-      newV[y][x] = std::min(1.0f, std::max(0.0f, newV[y][x]));
+  if (mode == "--benchmark") {
+    int size = args.size() > 0 ? std::atoi(args[0].c_str()) : 4096;
+    int steps = args.size() > 1 ? std::atoi(args[1].c_str()) : 20;
+    return runBenchmark(options.params, options.seed, size, steps);
+  }
+
+  if (mode == "--sweep") {
+    return runSweepMode(options);
+  }
+
+  if (mode == "--headless") {
+    if (args.empty()) {
+      std::cerr << "Usage: " << argv[0] << " --headless ITERATIONS [DUMP_EVERY] [PREFIX] [--raw] [--blocked | --imex]" << std::endl;
+      return 1;
     }
+    long iterations = std::atol(args[0].c_str());
+    long dumpEvery = args.size() > 1 ? std::atol(args[1].c_str()) : 0;
+    std::string prefix = args.size() > 2 ? args[2] : "frame";
+    return runHeadless(options, iterations, dumpEvery, prefix);
   }
 
-  u.swap(newU);
-  v.swap(newV);
-}
+  // Initialize the concentration grids
+  unsigned seed;
+  long step;
+  std::unique_ptr<Grid> start = startGrid(options, seed, step);
+  if (!start) return 1;
+  Grid& grid = *start;
+  const Params& params = grid.params;
+  RowKernel kernel = stencil::select();
+  std::unique_ptr<imex::Solver> solver; // Its FFT buffers are several times the size of the fields
+  if (options.imex) solver.reset(new imex::Solver(params, options.tolerance));
+
+  std::unique_ptr<CheckpointWriter> checkpoints;
+  if (!options.checkpointPath.empty()) checkpoints.reset(new CheckpointWriter(options.checkpointPath));
 
-int main() {
   // Initialize SFML window
-  sf::RenderWindow window(sf::VideoMode(WIDTH, HEIGHT), "Gray-Scott Model Simulation");
+  sf::RenderWindow window(sf::VideoMode(params.width, params.height), "Gray-Scott Model Simulation");
   window.setFramerateLimit(60);
 
-  // Initialize the concentration grids
-  std::vector<std::vector<float>> u(HEIGHT, std::vector<float>(WIDTH, 1.0f));
-  std::vector<std::vector<float>> v(HEIGHT, std::vector<float>(WIDTH, 0.0f));
-  initializeGrid(u, v);
-
   // Texture and sprite to visualize the grid
   sf::Texture texture;
-  texture.create(WIDTH, HEIGHT);
+  texture.create(params.width, params.height);
   sf::Sprite sprite(texture);
 
-  // Buffer for pixel data
-  std::vector<sf::Uint8> pixels(WIDTH * HEIGHT * 4);
+  // Converts each frame to pixels on its own thread while the next batch of steps runs
+  ColormapStage colormapStage(params.width, params.height);
 
   // Main simulation loop
   while (window.isOpen()) {
@@ -131,32 +402,33 @@ int main() {
       }
     }
 
-    // Update the simulation multiple times per frame
-    for (int i = 0; i < ITERATIONS_PER_FRAME; ++i) {
-      updateGrid(u, v);
-    }
+    colormapStage.submit(grid.u, grid.v);
 
-    // Render the grid to the screen
-    for (int y = 0; y < HEIGHT; ++y) {
-      for (int x = 0; x < WIDTH; ++x) {
-        float color = u[y][x] - v[y][x];
-        color = std::min(1.0f, std::max(0.0f, color));
-
-        // Use color gradient based on U-V values
-        pixels[4 * (y * WIDTH + x) + 0] = static_cast<sf::Uint8>(color * 255);  // Red channel
-        pixels[4 * (y * WIDTH + x) + 1] = static_cast<sf::Uint8>((1.0f - color) * 255);  // Green channel
-        pixels[4 * (y * WIDTH + x) + 2] = 128; // Blue channel (constant)
-        pixels[4 * (y * WIDTH + x) + 3] = 255; // Alpha channel
+    // Update the simulation multiple times per frame; IMEX covers the same model time in its own steps
+    if (options.imex) {
+      solver->advance(grid, ITERATIONS_PER_FRAME * static_cast<double>(params.deltaT));
+    } else {
+      for (int i = 0; i < ITERATIONS_PER_FRAME; ++i) {
+        stencil::step(grid, kernel);
       }
     }
+    step += ITERATIONS_PER_FRAME;
+    if (checkpoints && options.checkpointEvery > 0 && step % options.checkpointEvery < ITERATIONS_PER_FRAME) {
+      checkpoints->save(grid, seed, step);
+    }
 
-    // Update texture and display it
-    texture.update(pixels.data());
+    // Render the grid as it was before this batch, converted meanwhile; update texture and display it
+    texture.update(colormapStage.wait());
     window.clear();
     window.draw(sprite);
     window.display();
   }
 
+  // Keep the state the window was closed on
+  if (checkpoints) {
+    checkpoints->save(grid, seed, step);
+    if (!checkpoints->finish()) return 1;
+  }
   return 0;
 }
 
@@ -0,0 +1,134 @@
+#include "stencil_kernel.hpp"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STENCIL_X86 1
+#endif
+
+void stencil::rowScalar(const float* uNorth, const float* u, const float* uSouth,
+                        const float* vNorth, const float* v, const float* vSouth,
+                        float* newU, float* newV, int count, const Params& params) {
+  for (int x = 0; x < count; ++x) {
+    float lapU = laplacian(uNorth, u, uSouth, x);
+    float lapV = laplacian(vNorth, v, vSouth, x);
+
+    float uvv = u[x] * v[x] * v[x];
+    float nextU = u[x] + (params.du * lapU - uvv + params.feed * (1.0f - u[x])) * params.deltaT;
+    float nextV = v[x] + (params.dv * lapV + uvv - (params.feed + params.kill) * v[x]) * params.deltaT;
+
+    newU[x] = std::min(1.0f, std::max(0.0f, nextU));
+    newV[x] = std::min(1.0f, std::max(0.0f, nextV));
+  }
+}
+
+#ifdef STENCIL_X86
+
+// 9-point Laplacian of 8 consecutive cells, summed in the order of laplacian()
+__attribute__((target("avx2")))
+static inline __m256 laplacianAvx2(const float* north, const float* center, const float* south) {
+  const __m256 side = _mm256_set1_ps(0.2f);
+  const __m256 corner = _mm256_set1_ps(0.05f);
+
+  __m256 result = _mm256_setzero_ps();
+  result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_loadu_ps(center), _mm256_set1_ps(-1.0f)));
+  result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_loadu_ps(south), side));
+  result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_loadu_ps(north), side));
+  result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_loadu_ps(center + 1), side));
+  result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_loadu_ps(center - 1), side));
+  result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_loadu_ps(south + 1), corner));
+  result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_loadu_ps(south - 1), corner));
+  result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_loadu_ps(north + 1), corner));
+  result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_loadu_ps(north - 1), corner));
+  return result;
+}
+
+__attribute__((target("avx2")))
+void stencil::rowAvx2(const float* uNorth, const float* u, const float* uSouth,
+                      const float* vNorth, const float* v, const float* vSouth,
+                      float* newU, float* newV, int count, const Params& params) {
+  const __m256 du = _mm256_set1_ps(params.du);
+  const __m256 dv = _mm256_set1_ps(params.dv);
+  const __m256 feed = _mm256_set1_ps(params.feed);
+  const __m256 feedKill = _mm256_set1_ps(params.feed + params.kill);
+  const __m256 dt = _mm256_set1_ps(params.deltaT);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+
+  int x = 0;
+  for (; x + 8 <= count; x += 8) {
+    __m256 lapU = laplacianAvx2(uNorth + x, u + x, uSouth + x);
+    __m256 lapV = laplacianAvx2(vNorth + x, v + x, vSouth + x);
+    __m256 cu = _mm256_loadu_ps(u + x);
+    __m256 cv = _mm256_loadu_ps(v + x);
+
+    __m256 uvv = _mm256_mul_ps(_mm256_mul_ps(cu, cv), cv);
+
+    // u + (du * lapU - uvv + feed * (1 - u)) * deltaT
+    __m256 rateU = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(du, lapU), uvv),
+                                 _mm256_mul_ps(feed, _mm256_sub_ps(one, cu)));
+    __m256 nextU = _mm256_add_ps(cu, _mm256_mul_ps(rateU, dt));
+
+    // v + (dv * lapV + uvv - (feed + kill) * v) * deltaT
+    __m256 rateV = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(dv, lapV), uvv),
+                                 _mm256_mul_ps(feedKill, cv));
+    __m256 nextV = _mm256_add_ps(cv, _mm256_mul_ps(rateV, dt));
+
+    _mm256_storeu_ps(newU + x, _mm256_min_ps(one, _mm256_max_ps(zero, nextU)));
+    _mm256_storeu_ps(newV + x, _mm256_min_ps(one, _mm256_max_ps(zero, nextV)));
+  }
+
+  // Remaining cells of the row
+  rowScalar(uNorth + x, u + x, uSouth + x, vNorth + x, v + x, vSouth + x, newU + x, newV + x, count - x, params);
+}
+
+RowKernel stencil::select() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return &stencil::rowAvx2;
+  return &stencil::rowScalar;
+}
+
+#else
+
+void stencil::rowAvx2(const float* uNorth, const float* u, const float* uSouth,
+                      const float* vNorth, const float* v, const float* vSouth,
+                      float* newU, float* newV, int count, const Params& params) {
+  rowScalar(uNorth, u, uSouth, vNorth, v, vSouth, newU, newV, count, params);
+}
+
+RowKernel stencil::select() {
+  return &stencil::rowScalar;
+}
+
+#endif
+
+const char* stencil::name(RowKernel kernel) {
+  return kernel == &stencil::rowAvx2 ? "AVX2" : "scalar";
+}
+
+void stencil::step(Grid& grid, RowKernel kernel, bool parallel) {
+  int width = grid.u.width();
+  int height = grid.u.height();
+  grid.u.fillGhosts();
+  grid.v.fillGhosts();
+
+  int tilesY = (height + TILE_ROWS - 1) / TILE_ROWS;
+  int tilesX = (width + TILE_COLUMNS - 1) / TILE_COLUMNS;
+
+  #pragma omp parallel for schedule(static) if (parallel)
+  for (int tile = 0; tile < tilesX * tilesY; ++tile) {
+    int x0 = (tile % tilesX) * TILE_COLUMNS;
+    int y0 = (tile / tilesX) * TILE_ROWS;
+    int count = std::min(TILE_COLUMNS, width - x0);
+    int yEnd = std::min(height, y0 + TILE_ROWS);
+
+    for (int y = y0; y < yEnd; ++y) {
+      kernel(grid.u.row(y - 1) + x0, grid.u.row(y) + x0, grid.u.row(y + 1) + x0,
+             grid.v.row(y - 1) + x0, grid.v.row(y) + x0, grid.v.row(y + 1) + x0,
+             grid.nextU.row(y) + x0, grid.nextV.row(y) + x0, count, grid.params);
+    }
+  }
+
+  grid.u.swap(grid.nextU);
+  grid.v.swap(grid.nextV);
+}
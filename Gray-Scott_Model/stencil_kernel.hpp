@@ -0,0 +1,39 @@
+#ifndef STENCIL_KERNEL_HPP
+#define STENCIL_KERNEL_HPP
+#include "gray_scott.hpp"
+
+// Advance `count` cells of one row by one Gray-Scott step.
+// The inputs point at cell 0 of rows y - 1, y and y + 1 of U and V; cells -1
+// and `count` of those rows must be readable (ghost cells or tile halo).
+typedef void (*RowKernel)(const float* uNorth, const float* u, const float* uSouth,
+                          const float* vNorth, const float* v, const float* vSouth,
+                          float* newU, float* newV, int count, const Params& params);
+
+namespace stencil {
+
+  // Tile processed by one thread at a time: a block of rows, split into column
+  // strips so the three input rows of both fields stay in L1
+  const int TILE_ROWS = 64;
+  const int TILE_COLUMNS = 512;
+
+  // Same arithmetic as updateGrid, one cell at a time
+  void rowScalar(const float* uNorth, const float* u, const float* uSouth,
+                 const float* vNorth, const float* v, const float* vSouth,
+                 float* newU, float* newV, int count, const Params& params);
+
+  // 8 cells per instruction. The operations are the ones of rowScalar in the
+  // same order and without FMA, so the results are bit-identical.
+  void rowAvx2(const float* uNorth, const float* u, const float* uSouth,
+               const float* vNorth, const float* v, const float* vSouth,
+               float* newU, float* newV, int count, const Params& params);
+
+  // Fastest kernel the running CPU supports
+  RowKernel select();
+  const char* name(RowKernel kernel);
+
+  // One step of the whole grid, tiles distributed over threads with OpenMP.
+  // parallel = false keeps it on the calling thread (e.g. when grids are run concurrently).
+  void step(Grid& grid, RowKernel kernel, bool parallel = true);
+}
+
+#endif
@@ -0,0 +1,88 @@
+#include "sweep.hpp"
+#include "stencil_kernel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+namespace {
+
+  float interpolate(float min, float max, int i, int steps) {
+    return steps > 1 ? min + (max - min) * i / (steps - 1) : min;
+  }
+
+  SweepResult runPoint(const SweepConfig& config, float feed, float kill, RowKernel kernel) {
+    Params params = config.base;
+    params.feed = feed;
+    params.kill = kill;
+
+    Grid grid(params);
+    initializeGrid(grid.u, grid.v, config.seed);
+
+    int lag = std::min(config.stationarityLag, config.steps);
+    for (int i = 0; i < config.steps - lag; ++i) stencil::step(grid, kernel, false);
+    Field previousV = grid.v;
+    for (int i = 0; i < lag; ++i) stencil::step(grid, kernel, false);
+
+    double sumU = 0.0, sumV = 0.0, sumV2 = 0.0, sumChange2 = 0.0;
+    for (int y = 0; y < params.height; ++y) {
+      const float* u = grid.u.row(y);
+      const float* v = grid.v.row(y);
+      const float* before = previousV.row(y);
+      for (int x = 0; x < params.width; ++x) {
+        sumU += u[x];
+        sumV += v[x];
+        sumV2 += static_cast<double>(v[x]) * v[x];
+        sumChange2 += static_cast<double>(v[x] - before[x]) * (v[x] - before[x]);
+      }
+    }
+
+    double cells = static_cast<double>(params.width) * params.height;
+    SweepResult result;
+    result.feed = feed;
+    result.kill = kill;
+    result.meanU = sumU / cells;
+    result.meanV = sumV / cells;
+    result.stdV = std::sqrt(std::max(0.0, sumV2 / cells - result.meanV * result.meanV));
+    result.change = lag > 0 ? std::sqrt(sumChange2 / cells) / lag : 0.0;
+    return result;
+  }
+}
+
+std::vector<SweepResult> runSweep(const SweepConfig& config) {
+  int points = config.feedSteps * config.killSteps;
+  std::vector<SweepResult> results(points);
+  RowKernel kernel = stencil::select();
+
+  unsigned threads = config.threads ? config.threads : std::thread::hardware_concurrency();
+  threads = std::max(1u, std::min(threads, static_cast<unsigned>(points)));
+
+  // Workers take the next unfinished point until none are left
+  std::atomic<int> next(0);
+  auto worker = [&]() {
+    for (int i = next++; i < points; i = next++) {
+      float feed = interpolate(config.feedMin, config.feedMax, i % config.feedSteps, config.feedSteps);
+      float kill = interpolate(config.killMin, config.killMax, i / config.feedSteps, config.killSteps);
+      results[i] = runPoint(config, feed, kill, kernel);
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+  worker();
+  for (auto& thread : pool) thread.join();
+
+  return results;
+}
+
+bool writeSweepTable(const std::string& path, const std::vector<SweepResult>& results) {
+  std::FILE* file = std::fopen(path.c_str(), "w");
+  if (!file) return false;
+
+  std::fprintf(file, "# feed \t kill \t mean_u \t mean_v \t std_v \t change_per_step\n");
+  for (const SweepResult& r : results) {
+    std::fprintf(file, "%g\t%g\t%g\t%g\t%g\t%g\n", r.feed, r.kill, r.meanU, r.meanV, r.stdV, r.change);
+  }
+  return std::fclose(file) == 0;
+}
@@ -0,0 +1,36 @@
+#ifndef SWEEP_HPP
+#define SWEEP_HPP
+#include <string>
+#include <vector>
+#include "gray_scott.hpp"
+
+// A grid of (feed, kill) values, each run as an independent small simulation
+struct SweepConfig {
+  Params base;                // Size, diffusion rates and time step shared by all points
+  float feedMin = 0.01f, feedMax = 0.1f;
+  int feedSteps = 10;
+  float killMin = 0.045f, killMax = 0.07f;
+  int killSteps = 10;
+  int steps = 5000;           // Iterations per point
+  int stationarityLag = 100;  // Steps between the two snapshots compared for the stationarity metric
+  unsigned seed = 1;          // Same initial blobs for every point
+  unsigned threads = 0;       // 0 = one per core
+};
+
+// Summary of one finished simulation
+struct SweepResult {
+  float feed, kill;
+  double meanU, meanV;
+  double stdV;    // Spatial standard deviation of V: ~0 for uniform states, large for patterns
+  double change;  // RMS change of V per step over the last stationarityLag steps: ~0 once stationary
+};
+
+// Run every point of the sweep, spread over worker threads. Each simulation
+// owns its grid and generator and runs single-threaded, so the points share
+// no mutable state. The results are ordered by kill, then feed.
+std::vector<SweepResult> runSweep(const SweepConfig& config);
+
+// Write the results as a whitespace separated table with a # header
+bool writeSweepTable(const std::string& path, const std::vector<SweepResult>& results);
+
+#endif
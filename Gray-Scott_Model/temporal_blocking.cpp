@@ -0,0 +1,106 @@
+#include "temporal_blocking.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+  // Copy `count` cells of a periodic row starting at column `start`
+  void copyWrapped(const float* row, int width, int start, int count, float* out) {
+    int x = ((start % width) + width) % width;
+    while (count > 0) {
+      int chunk = std::min(count, width - x);
+      std::copy(row + x, row + x + chunk, out);
+      out += chunk;
+      count -= chunk;
+      x = 0;
+    }
+  }
+
+  // Private buffers of one thread: a (tile + 2 * halo)^2 block of U and V, twice
+  struct TileBuffers {
+    int side = 0;
+    std::vector<float> u, v, nextU, nextV;
+
+    void resize(int newSide) {
+      if (side == newSide) return;
+      side = newSide;
+      u.assign(side * side, 0.0f);
+      v.assign(side * side, 0.0f);
+      nextU.assign(side * side, 0.0f);
+      nextV.assign(side * side, 0.0f);
+    }
+  };
+
+  // Advance the tile with corner (x0, y0) by `depth` steps into grid.nextU / grid.nextV
+  void advanceTile(Grid& grid, int x0, int y0, int tileWidth, int tileHeight, int depth,
+                   RowKernel kernel, TileBuffers& buffers) {
+    int width = grid.u.width();
+    int height = grid.u.height();
+    int side = buffers.side;
+    int localWidth = tileWidth + 2 * depth;
+    int localHeight = tileHeight + 2 * depth;
+
+    // Load the tile and its halo; the modulo only happens here, once per row
+    for (int ly = 0; ly < localHeight; ++ly) {
+      int y = ((y0 - depth + ly) % height + height) % height;
+      copyWrapped(grid.u.row(y), width, x0 - depth, localWidth, &buffers.u[ly * side]);
+      copyWrapped(grid.v.row(y), width, x0 - depth, localWidth, &buffers.v[ly * side]);
+    }
+
+    // Step s is valid on [s, local - s) in both directions
+    for (int s = 1; s < depth; ++s) {
+      for (int ly = s; ly < localHeight - s; ++ly) {
+        const float* u = &buffers.u[ly * side + s];
+        const float* v = &buffers.v[ly * side + s];
+        kernel(u - side, u, u + side, v - side, v, v + side,
+               &buffers.nextU[ly * side + s], &buffers.nextV[ly * side + s], localWidth - 2 * s, grid.params);
+      }
+      buffers.u.swap(buffers.nextU);
+      buffers.v.swap(buffers.nextV);
+    }
+
+    // The last step covers exactly the tile and writes straight into the grid
+    for (int y = 0; y < tileHeight; ++y) {
+      const float* u = &buffers.u[(y + depth) * side + depth];
+      const float* v = &buffers.v[(y + depth) * side + depth];
+      kernel(u - side, u, u + side, v - side, v, v + side,
+             grid.nextU.row(y0 + y) + x0, grid.nextV.row(y0 + y) + x0, tileWidth, grid.params);
+    }
+  }
+
+  // One fused sweep of `depth` steps over the whole grid
+  void sweep(Grid& grid, int depth, int tileSize, RowKernel kernel) {
+    int width = grid.u.width();
+    int height = grid.u.height();
+    tileSize = std::min(tileSize, std::max(width, height));
+    int tilesX = (width + tileSize - 1) / tileSize;
+    int tilesY = (height + tileSize - 1) / tileSize;
+
+    #pragma omp parallel
+    {
+      // Kept per thread between sweeps, only reallocated when the shape changes
+      static thread_local TileBuffers buffers;
+      buffers.resize(tileSize + 2 * depth);
+
+      #pragma omp for schedule(static)
+      for (int tile = 0; tile < tilesX * tilesY; ++tile) {
+        int x0 = (tile % tilesX) * tileSize;
+        int y0 = (tile / tilesX) * tileSize;
+        advanceTile(grid, x0, y0, std::min(tileSize, width - x0), std::min(tileSize, height - y0),
+                    depth, kernel, buffers);
+      }
+    }
+
+    grid.u.swap(grid.nextU);
+    grid.v.swap(grid.nextV);
+  }
+}
+
+void temporal::advance(Grid& grid, int steps, RowKernel kernel, int depth, int tileSize) {
+  depth = std::max(1, depth);
+  while (steps > 0) {
+    int fused = std::min(depth, steps);
+    sweep(grid, fused, tileSize, kernel);
+    steps -= fused;
+  }
+}
@@ -0,0 +1,32 @@
+#ifndef TEMPORAL_BLOCKING_HPP
+#define TEMPORAL_BLOCKING_HPP
+#include "stencil_kernel.hpp"
+
+/* Temporally blocked Gray-Scott stepping.
+ *
+ * The plain step streams both fields through memory once per iteration. Here
+ * the grid is cut into tiles, and each tile is copied into a private buffer
+ * together with a halo of `depth` cells (overlapped tiling). The buffer is then
+ * advanced `depth` steps while it stays in cache: every step the valid region
+ * shrinks by one cell on each side, and the last step, which covers exactly
+ * the tile, writes into the grid. The halo cells are computed by several tiles,
+ * but memory sees one read and one write of each field per `depth` steps.
+ *
+ * This pays off once the grid is far larger than the caches and the plain
+ * step is limited by memory bandwidth (large grids, many threads). On a
+ * single core the plain step is compute bound and the halo work makes this
+ * slower; run --benchmark to see which one wins on a given machine.
+ *
+ * Every cell goes through the same row kernel as stencil::step, so the result
+ * is bit-identical to running the steps one by one.
+ */
+namespace temporal {
+
+  const int DEFAULT_DEPTH = 8;       // Steps fused per sweep
+  const int DEFAULT_TILE_SIZE = 240; // Tile side; with the halo, 4 buffers of 256x256 floats (1 MB) fit in L2
+
+  // Advance the grid by `steps` steps, `depth` at a time
+  void advance(Grid& grid, int steps, RowKernel kernel, int depth = DEFAULT_DEPTH, int tileSize = DEFAULT_TILE_SIZE);
+}
+
+#endif
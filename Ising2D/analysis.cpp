@@ -0,0 +1,264 @@
+#include "analysis.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+
+    // In-place radix-2 FFT; the size must be a power of two. inverse leaves out the 1/n.
+    void fft(std::vector<std::complex<double>>& data, bool inverse) {
+        size_t n = data.size();
+        for (size_t i = 1, j = 0; i < n; i++) {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if (i < j) std::swap(data[i], data[j]);
+        }
+        const double pi = std::acos(-1.0);
+        for (size_t length = 2; length <= n; length <<= 1) {
+            double angle = (inverse ? 2 : -2) * pi / length;
+            std::complex<double> unit(std::cos(angle), std::sin(angle));
+            for (size_t start = 0; start < n; start += length) {
+                std::complex<double> twiddle(1.0, 0.0);
+                for (size_t k = 0; k < length / 2; k++) {
+                    std::complex<double> a = data[start + k];
+                    std::complex<double> b = data[start + k + length / 2] * twiddle;
+                    data[start + k] = a + b;
+                    data[start + k + length / 2] = a - b;
+                    twiddle *= unit;
+                }
+            }
+        }
+    }
+}
+
+namespace sys{
+
+    std::vector<double> autocorrelation_function(const std::vector<double>& series) {
+        size_t n = series.size();
+        if (n == 0) return std::vector<double>();
+
+        // Padding to at least 2n keeps the circular correlation of the FFT from
+        // wrapping the end of the series onto its start
+        size_t padded = 1;
+        while (padded < 2 * n) padded <<= 1;
+        double mu = 0.0;
+        for (double value : series) mu += value;
+        mu /= n;
+        std::vector<std::complex<double>> data(padded);
+        for (size_t t = 0; t < n; t++) data[t] = series[t] - mu;
+
+        // Wiener-Khinchin: the autocovariance sums are the inverse transform of the power spectrum
+        fft(data, false);
+        for (std::complex<double>& value : data) value = std::norm(value);
+        fft(data, true);
+
+        std::vector<double> rho(n, 0.0);
+        double variance = data[0].real() / padded / n;
+        if (variance <= 1e-300) {
+            rho.assign(n, 0.0);
+            rho[0] = 1.0;
+            return rho;
+        }
+        for (size_t h = 0; h < n; h++) rho[h] = data[h].real() / padded / (n - h) / variance;
+        return rho;
+    }
+
+    AutocorrelationTime integrated_autocorrelation_time(const std::vector<double>& rho, double c) {
+        AutocorrelationTime result;
+        double tau = 0.5;
+        for (size_t w = 1; w < rho.size(); w++) {
+            tau += rho[w];
+            if (w >= c * tau) {
+                result.tau = tau;
+                result.window = static_cast<int>(w);
+                result.reliable = true;
+                return result;
+            }
+        }
+        result.tau = tau;
+        result.window = rho.empty() ? 0 : static_cast<int>(rho.size() - 1);
+        return result;
+    }
+
+    void BinningAccumulator::add(double value) {
+        add_to_level(0, value);
+    }
+
+    void BinningAccumulator::add_to_level(int level, double value) {
+        if (level == static_cast<int>(levels.size())) levels.push_back(Level());
+        Level& bin = levels[level];
+        bin.count++;
+        double delta = value - bin.mean;
+        bin.mean += delta / bin.count;
+        bin.m2 += delta * (value - bin.mean);
+
+        if (!bin.has_pending) {
+            bin.pending = value;
+            bin.has_pending = true;
+            return;
+        }
+        bin.has_pending = false;
+        add_to_level(level + 1, 0.5 * (bin.pending + value)); // May reallocate levels, bin is not used after
+    }
+
+    double BinningAccumulator::variance() const {
+        if (levels.empty() || levels[0].count < 2) return 0.0;
+        return levels[0].m2 / (levels[0].count - 1);
+    }
+
+    double BinningAccumulator::error(int level) const {
+        if (level < 0 || level >= static_cast<int>(levels.size()) || levels[level].count < 2) return 0.0;
+        const Level& bin = levels[level];
+        return std::sqrt(bin.m2 / (bin.count - 1) / bin.count);
+    }
+
+    double BinningAccumulator::error() const {
+        // The plateau is noisy at the deep levels, which have few blocks, so take
+        // the largest error among the levels that still have enough of them
+        double largest = error(0);
+        for (int level = 1; level < level_count() && levels[level].count >= MIN_BLOCKS; level++) {
+            largest = std::max(largest, error(level));
+        }
+        return largest;
+    }
+
+    double BinningAccumulator::autocorrelation_time() const {
+        double naive = error(0);
+        if (naive <= 0.0) return 0.5;
+        double ratio = error() / naive;
+        return 0.5 * ratio * ratio;
+    }
+
+    void IsingObservables::Moments::add(const Moments& other) {
+        m1 += other.m1;
+        m2 += other.m2;
+        m4 += other.m4;
+        e1 += other.e1;
+        e2 += other.e2;
+        count += other.count;
+    }
+
+    IsingObservables::IsingObservables(long long sites, double beta) : sites(sites), beta(beta) {
+        blocks.reserve(2 * BLOCKS);
+    }
+
+    void IsingObservables::add(double m, double e) {
+        absolute.add(std::fabs(m));
+        energies.add(e);
+
+        double m2 = m * m;
+        current.m1 += std::fabs(m);
+        current.m2 += m2;
+        current.m4 += m2 * m2;
+        current.e1 += e;
+        current.e2 += e * e;
+        current.count++;
+        if (current.count < block_length) return;
+
+        blocks.push_back(current);
+        current = Moments();
+        if (static_cast<int>(blocks.size()) == 2 * BLOCKS) {
+            // Pairs of blocks become one of twice the length, so the number of
+            // blocks stays between BLOCKS and 2 * BLOCKS however long the run is
+            for (int i = 0; i < BLOCKS; i++) {
+                blocks[i] = blocks[2 * i];
+                blocks[i].add(blocks[2 * i + 1]);
+            }
+            blocks.resize(BLOCKS);
+            block_length *= 2;
+        }
+    }
+
+    double IsingObservables::susceptibility_of(const Moments& sums) const {
+        if (sums.count == 0) return 0.0;
+        double m1 = sums.m1 / sums.count;
+        return beta * sites * (sums.m2 / sums.count - m1 * m1);
+    }
+
+    double IsingObservables::specific_heat_of(const Moments& sums) const {
+        if (sums.count == 0) return 0.0;
+        double e1 = sums.e1 / sums.count;
+        return beta * beta * sites * (sums.e2 / sums.count - e1 * e1);
+    }
+
+    double IsingObservables::binder_of(const Moments& sums) const {
+        if (sums.count == 0 || sums.m2 == 0.0) return 0.0;
+        double m2 = sums.m2 / sums.count;
+        return 1.0 - sums.m4 / sums.count / (3.0 * m2 * m2);
+    }
+
+    Estimate IsingObservables::jackknife(Derived quantity) const {
+        Moments total = current;
+        for (const Moments& block : blocks) total.add(block);
+
+        Estimate estimate;
+        estimate.value = (this->*quantity)(total);
+        int count = static_cast<int>(blocks.size());
+        if (count < 2) return estimate;
+
+        // Leave one full block out at a time; the partial block stays in every sample
+        std::vector<double> samples(count);
+        double average = 0.0;
+        for (int i = 0; i < count; i++) {
+            Moments rest = total;
+            rest.m1 -= blocks[i].m1;
+            rest.m2 -= blocks[i].m2;
+            rest.m4 -= blocks[i].m4;
+            rest.e1 -= blocks[i].e1;
+            rest.e2 -= blocks[i].e2;
+            rest.count -= blocks[i].count;
+            samples[i] = (this->*quantity)(rest);
+            average += samples[i];
+        }
+        average /= count;
+        double spread = 0.0;
+        for (double sample : samples) spread += (sample - average) * (sample - average);
+        estimate.error = std::sqrt(spread * (count - 1) / count);
+        return estimate;
+    }
+
+    Estimate IsingObservables::magnetization() const {
+        Estimate estimate;
+        estimate.value = absolute.mean();
+        estimate.error = absolute.error();
+        return estimate;
+    }
+
+    Estimate IsingObservables::energy() const {
+        Estimate estimate;
+        estimate.value = energies.mean();
+        estimate.error = energies.error();
+        return estimate;
+    }
+
+    Estimate IsingObservables::susceptibility() const {
+        return jackknife(&IsingObservables::susceptibility_of);
+    }
+
+    Estimate IsingObservables::specific_heat() const {
+        return jackknife(&IsingObservables::specific_heat_of);
+    }
+
+    Estimate IsingObservables::binder_cumulant() const {
+        return jackknife(&IsingObservables::binder_of);
+    }
+
+    bool read_series(const std::string& path, std::vector<double>& series) {
+        std::ifstream file(path.c_str());
+        if (!file) return false;
+        series.clear();
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#') continue;
+            char* end = nullptr;
+            double value = std::strtod(line.c_str() + first, &end);
+            if (end == line.c_str() + first) return false;
+            series.push_back(value);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef ANALYSIS_HPP
+#define ANALYSIS_HPP
+#include <string>
+#include <vector>
+
+namespace sys{
+
+    // Normalized autocorrelation of a series at every lag h = 0..n-1 (rho[0] = 1),
+    // the same values as sys::autocorrelation(series, h) for each h, from one
+    // zero-padded FFT of the series: O(n log n) instead of O(n) per lag
+    std::vector<double> autocorrelation_function(const std::vector<double>& series);
+
+    // Integrated autocorrelation time tau = 1/2 + sum_{h=1..W} rho(h) with
+    // Sokal's automatic window: the smallest W with W >= c * tau(W). Windows
+    // that never close within the series mean it is too short to trust tau.
+    struct AutocorrelationTime {
+        double tau = 0.5;
+        int window = 0;
+        bool reliable = false;
+    };
+    AutocorrelationTime integrated_autocorrelation_time(const std::vector<double>& rho, double c = 6.0);
+
+    // Streaming mean and error of one series with binning analysis. Level k
+    // keeps a Welford mean and variance of the averages of 2^k consecutive
+    // values, so the naive error of level 0 grows with k until the blocks are
+    // longer than the autocorrelation time, where it levels off at the true
+    // error. Memory is O(log n), whatever the length of the series.
+    class BinningAccumulator {
+    public:
+        void add(double value);
+
+        long long count() const { return levels.empty() ? 0 : levels[0].count; }
+        double mean() const { return levels.empty() ? 0.0 : levels[0].mean; }
+        double variance() const;            // Of the values themselves
+
+        // Error of the mean from level k (0 = as if uncorrelated), 0 without two blocks
+        double error(int level) const;
+        int level_count() const { return static_cast<int>(levels.size()); }
+
+        // Largest error over the levels that still have MIN_BLOCKS blocks
+        double error() const;
+
+        // tau = (error / naive error)^2 / 2, which the binning plateau implies
+        double autocorrelation_time() const;
+
+        static const int MIN_BLOCKS = 32;
+
+    private:
+        struct Level {
+            long long count = 0;
+            double mean = 0.0, m2 = 0.0;    // Welford sums
+            double pending = 0.0;           // First half of the next block, if has_pending
+            bool has_pending = false;
+        };
+        void add_to_level(int level, double value);
+
+        std::vector<Level> levels;
+    };
+
+    struct Estimate {
+        double value = 0.0;
+        double error = 0.0;
+    };
+
+    // Observables of an Ising run (J = 1) fed one measurement per sweep:
+    // magnetization and energy per spin. Nothing of the series is stored.
+    // Means come with binning errors; the susceptibility, specific heat and
+    // Binder cumulant, which are nonlinear in the means, take jackknife
+    // errors over at most 2 * BLOCKS blocks whose length doubles as the run
+    // grows.
+    class IsingObservables {
+    public:
+        IsingObservables(long long sites, double beta);
+
+        void add(double m, double e);
+
+        long long count() const { return absolute.count(); }
+        Estimate magnetization() const;      // <|m|>
+        Estimate energy() const;             // <e>
+        Estimate susceptibility() const;     // beta N (<m^2> - <|m|>^2)
+        Estimate specific_heat() const;      // beta^2 N (<e^2> - <e>^2)
+        Estimate binder_cumulant() const;    // 1 - <m^4> / (3 <m^2>^2)
+
+        // Autocorrelation times of |m| and e from the binning plateaus
+        double tau_magnetization() const { return absolute.autocorrelation_time(); }
+        double tau_energy() const { return energies.autocorrelation_time(); }
+
+        static const int BLOCKS = 64;
+
+    private:
+        struct Moments {
+            double m1 = 0, m2 = 0, m4 = 0, e1 = 0, e2 = 0; // Sums of |m|, m^2, m^4, e, e^2
+            long long count = 0;
+
+            void add(const Moments& other);
+        };
+        typedef double (IsingObservables::*Derived)(const Moments&) const;
+
+        double susceptibility_of(const Moments& sums) const;
+        double specific_heat_of(const Moments& sums) const;
+        double binder_of(const Moments& sums) const;
+        Estimate jackknife(Derived quantity) const;
+
+        long long sites;
+        double beta;
+        BinningAccumulator absolute, energies;
+        std::vector<Moments> blocks;         // Full blocks of block_length measurements
+        Moments current;                     // The block being filled
+        long long block_length = 1;
+    };
+
+    // Read a series written one value per line (lines starting with # are skipped)
+    bool read_series(const std::string& path, std::vector<double>& series);
+}
+
+#endif
@@ -0,0 +1,213 @@
+#include "bit_lattice.hpp"
+#include <algorithm>
+#include <cmath>
+#include "philox.hpp"
+
+namespace sys{
+
+    namespace {
+
+        std::uint64_t rotate_left(std::uint64_t x) { return (x << 1) | (x >> 63); }
+        std::uint64_t rotate_right(std::uint64_t x) { return (x >> 1) | (x << 63); }
+
+        int popcount(std::uint64_t x) { return __builtin_popcountll(x); }
+
+        // Generator for one row of one colour of one sweep: two Philox blocks
+        // keyed by the seed give its 256-bit state, so rows draw independent
+        // numbers whichever thread runs them
+        rng::Xoshiro256 row_generator(std::uint64_t seed, std::uint64_t sweep_index, int color, int y) {
+            philox::Key key = {{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)}};
+            philox::Counter counter = {{static_cast<std::uint32_t>(y), static_cast<std::uint32_t>(color) << 1,
+                                        static_cast<std::uint32_t>(sweep_index), static_cast<std::uint32_t>(sweep_index >> 32)}};
+            philox::Counter low = philox::block(counter, key);
+            counter[1] |= 1;
+            philox::Counter high = philox::block(counter, key);
+
+            auto join = [](std::uint32_t a, std::uint32_t b) { return (static_cast<std::uint64_t>(a) << 32) | b; };
+            rng::Xoshiro256 random;
+            random.set_state(join(low[0], low[1]), join(low[2], low[3]), join(high[0], high[1]), join(high[2], high[3]));
+            return random;
+        }
+    }
+
+    AcceptanceTable::AcceptanceTable(double beta) {
+        for (int a = 0; a <= 4; a++) {
+            probability[a] = std::min(1.0, std::exp(-beta * (8 - 4 * a)));
+            threshold[a] = probability[a] >= 1.0 ? 0xFFFFFFFFu : static_cast<std::uint32_t>(probability[a] * 4294967296.0);
+        }
+    }
+
+    std::uint64_t bernoulli_mask(std::uint64_t lanesA, std::uint32_t thresholdA,
+                                 std::uint64_t lanesB, std::uint32_t thresholdB, rng::Xoshiro256& random) {
+        // Saturated thresholds are certain
+        std::uint64_t result = (thresholdA == 0xFFFFFFFFu ? lanesA : 0) | (thresholdB == 0xFFFFFFFFu ? lanesB : 0);
+        if (thresholdA == 0xFFFFFFFFu) lanesA = 0;
+        if (thresholdB == 0xFFFFFFFFu) lanesB = 0;
+
+        // A lane is set when its uniform number, read bit by bit, is below its
+        // threshold: the first bit where the two differ decides the lane. Past
+        // the lowest set bit of both thresholds no open lane can get below.
+        std::uint32_t bits = (lanesA ? thresholdA : 0) | (lanesB ? thresholdB : 0);
+        int last = bits ? __builtin_ctz(bits) : 32;
+        std::uint64_t open = lanesA | lanesB;
+        for (int bit = 31; bit >= last && open; bit--) {
+            std::uint64_t threshold = (((thresholdA >> bit) & 1) ? lanesA : 0) | (((thresholdB >> bit) & 1) ? lanesB : 0);
+            std::uint64_t r = random.next();
+            result |= open & threshold & ~r;
+            open &= ~(threshold ^ r);
+        }
+        return result;
+    }
+
+    BitLattice::BitLattice(int width, int height) : cols(width), rows(height), stride(0) {
+        if (width % 128 == 0 && height % 2 == 0) {
+            stride = width / 64;
+            words.assign(static_cast<size_t>(stride) * height, ~0ull);
+        } else {
+            spins.assign(static_cast<size_t>(width) * height, 1);
+        }
+    }
+
+    int BitLattice::get(int x, int y) const {
+        if (!packed()) return spins[static_cast<size_t>(y) * cols + x];
+        std::uint64_t word = words[static_cast<size_t>(y) * stride + x % stride];
+        return (word >> (x / stride)) & 1 ? 1 : -1;
+    }
+
+    void BitLattice::set(int x, int y, int spin) {
+        if (!packed()) {
+            spins[static_cast<size_t>(y) * cols + x] = spin > 0 ? 1 : -1;
+            return;
+        }
+        std::uint64_t& word = words[static_cast<size_t>(y) * stride + x % stride];
+        std::uint64_t bit = 1ull << (x / stride);
+        word = spin > 0 ? word | bit : word & ~bit;
+    }
+
+    void BitLattice::randomize(rng::Xoshiro256& random) {
+        if (packed()) {
+            for (std::uint64_t& word : words) word = random.next();
+        } else {
+            for (std::int8_t& spin : spins) spin = random.next() >> 63 ? 1 : -1;
+        }
+    }
+
+    void BitLattice::from_config(const std::vector<std::vector<int>>& config) {
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < cols; x++) set(x, y, config[y][x]);
+        }
+    }
+
+    void BitLattice::to_config(std::vector<std::vector<int>>& config) const {
+        config.resize(rows);
+        for (int y = 0; y < rows; y++) {
+            config[y].resize(cols);
+            for (int x = 0; x < cols; x++) config[y][x] = get(x, y);
+        }
+    }
+
+    void BitLattice::sweep(const AcceptanceTable& table, rng::Xoshiro256& random) {
+        if (!packed()) {
+            sweep_scalar(table, random);
+            return;
+        }
+        // The two colours do not neighbour each other, so each half updates in place
+        for (int color = 0; color < 2; color++) {
+            for (int y = 0; y < rows; y++) update_row(y, color, table, random);
+        }
+    }
+
+    void BitLattice::sweep_parallel(const AcceptanceTable& table, std::uint64_t seed, std::uint64_t sweep_index) {
+        if (!packed()) {
+            rng::Xoshiro256 random = row_generator(seed, sweep_index, 0, 0);
+            sweep_scalar(table, random);
+            return;
+        }
+        // A row only reads the other colour, which nobody writes until the next pass
+        for (int color = 0; color < 2; color++) {
+            #pragma omp parallel for schedule(static)
+            for (int y = 0; y < rows; y++) {
+                rng::Xoshiro256 random = row_generator(seed, sweep_index, color, y);
+                update_row(y, color, table, random);
+            }
+        }
+    }
+
+    void BitLattice::update_row(int y, int color, const AcceptanceTable& table, rng::Xoshiro256& random) {
+        const std::uint32_t accept1 = table.threshold[1];
+        const std::uint32_t accept0 = table.threshold[0];
+        std::uint64_t* row = &words[static_cast<size_t>(y) * stride];
+        const std::uint64_t* up = &words[static_cast<size_t>(y == 0 ? rows - 1 : y - 1) * stride];
+        const std::uint64_t* down = &words[static_cast<size_t>(y == rows - 1 ? 0 : y + 1) * stride];
+
+        // The colour of word j in row y is (j + y) % 2
+        for (int j = (color + y) % 2; j < stride; j += 2) {
+            std::uint64_t spin = row[j];
+            std::uint64_t left = j > 0 ? row[j - 1] : rotate_left(row[stride - 1]);
+            std::uint64_t right = j < stride - 1 ? row[j + 1] : rotate_right(row[0]);
+
+            // Bitwise sum of the four antiparallel flags
+            std::uint64_t d0 = spin ^ left, d1 = spin ^ right, d2 = spin ^ up[j], d3 = spin ^ down[j];
+            std::uint64_t sum01 = d0 ^ d1, carry01 = d0 & d1;
+            std::uint64_t sum23 = d2 ^ d3, carry23 = d2 & d3;
+            std::uint64_t atLeastTwo = carry01 | carry23 | (sum01 & sum23);
+            std::uint64_t exactlyOne = ~atLeastTwo & (sum01 ^ sum23);
+            std::uint64_t none = ~(atLeastTwo | sum01 | sum23);
+
+            // a >= 2 always flips, a = 1 and a = 0 with their probabilities
+            std::uint64_t flip = atLeastTwo;
+            if (~atLeastTwo) flip |= bernoulli_mask(exactlyOne, accept1, none, accept0, random);
+            row[j] = spin ^ flip;
+        }
+    }
+
+    void BitLattice::sweep_scalar(const AcceptanceTable& table, rng::Xoshiro256& random) {
+        // Typewriter order; valid for any size, including odd ones where a checkerboard does not exist
+        for (int y = 0; y < rows; y++) {
+            const std::int8_t* up = &spins[static_cast<size_t>(y == 0 ? rows - 1 : y - 1) * cols];
+            std::int8_t* row = &spins[static_cast<size_t>(y) * cols];
+            const std::int8_t* down = &spins[static_cast<size_t>(y == rows - 1 ? 0 : y + 1) * cols];
+            for (int x = 0; x < cols; x++) {
+                int left = row[x == 0 ? cols - 1 : x - 1];
+                int right = row[x == cols - 1 ? 0 : x + 1];
+                int aligned = row[x] * (left + right + up[x] + down[x]); // 4 - 2a
+                int antiparallel = (4 - aligned) / 2;
+                std::uint32_t threshold = table.threshold[antiparallel];
+                if (threshold == 0xFFFFFFFFu || (random.next() >> 32) < threshold) row[x] = -row[x];
+            }
+        }
+    }
+
+    long long BitLattice::magnetization() const {
+        long long sum = 0;
+        if (packed()) {
+            for (std::uint64_t word : words) sum += popcount(word);
+            return 2 * sum - sites();
+        }
+        for (std::int8_t spin : spins) sum += spin;
+        return sum;
+    }
+
+    long long BitLattice::energy() const {
+        // Every site owns its bonds to the right and down
+        long long antiparallel = 0;
+        if (packed()) {
+            for (int y = 0; y < rows; y++) {
+                const std::uint64_t* row = &words[static_cast<size_t>(y) * stride];
+                const std::uint64_t* down = &words[static_cast<size_t>(y == rows - 1 ? 0 : y + 1) * stride];
+                for (int j = 0; j < stride; j++) {
+                    std::uint64_t right = j < stride - 1 ? row[j + 1] : rotate_right(row[0]);
+                    antiparallel += popcount(row[j] ^ right) + popcount(row[j] ^ down[j]);
+                }
+            }
+        } else {
+            for (int y = 0; y < rows; y++) {
+                for (int x = 0; x < cols; x++) {
+                    antiparallel += get(x, y) != get((x + 1) % cols, y);
+                    antiparallel += get(x, y) != get(x, (y + 1) % rows);
+                }
+            }
+        }
+        return 2 * antiparallel - 2 * sites();
+    }
+}
@@ -0,0 +1,125 @@
+#include "cluster_moves.hpp"
+#include <cmath>
+
+namespace sys{
+
+    namespace {
+
+        // Probability 1 - exp(-2 beta) of bonding two aligned spins, as a 32-bit threshold
+        std::uint32_t bond_threshold(double beta) {
+            double p = 1.0 - std::exp(-2.0 * beta);
+            return p >= 1.0 ? 0xFFFFFFFFu : static_cast<std::uint32_t>(p * 4294967296.0);
+        }
+
+        bool bond(std::uint32_t threshold, rng::Xoshiro256& random) {
+            return threshold == 0xFFFFFFFFu || (random.next() >> 32) < threshold;
+        }
+    }
+
+    ClusterUpdater::ClusterUpdater(int width, int height)
+        : cols(width), rows(height), spins(static_cast<size_t>(width) * height, 1), clusters(width * height),
+          decision(static_cast<size_t>(width) * height, 0) {
+        total = sites();
+    }
+
+    void ClusterUpdater::load(const BitLattice& lattice) {
+        total = 0;
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < cols; x++) {
+                spins[static_cast<size_t>(y) * cols + x] = static_cast<std::int8_t>(lattice.get(x, y));
+                total += lattice.get(x, y);
+            }
+        }
+    }
+
+    void ClusterUpdater::store(BitLattice& lattice) const {
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < cols; x++) lattice.set(x, y, spins[static_cast<size_t>(y) * cols + x]);
+        }
+    }
+
+    int ClusterUpdater::wolff(double beta, rng::Xoshiro256& random) {
+        const std::uint32_t threshold = bond_threshold(beta);
+        int seed = static_cast<int>(random.below(static_cast<std::uint32_t>(sites())));
+        std::int8_t orientation = spins[seed];
+
+        // Spins are flipped as they join, so a flipped neighbour is never added twice
+        int size = 1;
+        spins[seed] = -orientation;
+        stack.assign(1, seed);
+        while (!stack.empty()) {
+            int site = stack.back();
+            stack.pop_back();
+            int x = site % cols;
+            int y = site / cols;
+            int neighbours[4] = {
+                y * cols + (x == 0 ? cols - 1 : x - 1), y * cols + (x == cols - 1 ? 0 : x + 1),
+                (y == 0 ? rows - 1 : y - 1) * cols + x, (y == rows - 1 ? 0 : y + 1) * cols + x,
+            };
+            for (int neighbour : neighbours) {
+                if (spins[neighbour] == orientation && bond(threshold, random)) {
+                    spins[neighbour] = -orientation;
+                    stack.push_back(neighbour);
+                    size++;
+                }
+            }
+        }
+        total -= 2LL * orientation * size;
+        return size;
+    }
+
+    int ClusterUpdater::wolff_sweep(double beta, rng::Xoshiro256& random) {
+        long long flipped = 0;
+        int updates = 0;
+        do {
+            flipped += wolff(beta, random);
+            updates++;
+        } while (flipped < sites());
+        return updates;
+    }
+
+    void ClusterUpdater::swendsen_wang(double beta, rng::Xoshiro256& random) {
+        const std::uint32_t threshold = bond_threshold(beta);
+        clusters.reset();
+
+        // Every site owns its bonds to the right and down
+        for (int y = 0; y < rows; y++) {
+            int down = (y == rows - 1 ? 0 : y + 1) * cols;
+            for (int x = 0, site = y * cols; x < cols; x++, site++) {
+                int right = x == cols - 1 ? site - x : site + 1;
+                if (spins[site] == spins[right] && bond(threshold, random)) clusters.unite(site, right);
+                if (spins[site] == spins[down + x] && bond(threshold, random)) clusters.unite(site, down + x);
+            }
+        }
+
+        // Each cluster flips with probability 1/2, decided at the first site that meets its root
+        std::fill(decision.begin(), decision.end(), 0);
+        std::uint64_t bits = 0;
+        int available = 0;
+        total = 0;
+        for (int site = 0; site < cols * rows; site++) {
+            int root = clusters.find(site);
+            if (!decision[root]) {
+                if (available == 0) {
+                    bits = random.next();
+                    available = 64;
+                }
+                decision[root] = 1 + (bits & 1);
+                bits >>= 1;
+                available--;
+            }
+            if (decision[root] == 2) spins[site] = -spins[site];
+            total += spins[site];
+        }
+    }
+
+    long long ClusterUpdater::energy() const {
+        long long aligned = 0;
+        for (int y = 0; y < rows; y++) {
+            const std::int8_t* row = &spins[static_cast<size_t>(y) * cols];
+            const std::int8_t* down = &spins[static_cast<size_t>(y == rows - 1 ? 0 : y + 1) * cols];
+            for (int x = 0; x < cols; x++) aligned += row[x] * (row[x == cols - 1 ? 0 : x + 1] + down[x]);
+        }
+        return -aligned;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef CLUSTER_MOVES_HPP
+#define CLUSTER_MOVES_HPP
+#include <cstdint>
+#include <vector>
+#include "bit_lattice.hpp"
+#include "random_generator.hpp"
+#include "union_find.hpp"
+
+namespace sys{
+
+    // Cluster updates of the Ising model (J = 1, periodic boundaries), which
+    // flip whole correlated regions at once and so avoid most of the critical
+    // slowing down of single spin flips near T_c. Aligned neighbours are bonded
+    // with probability 1 - exp(-2 beta) (Fortuin-Kasteleyn).
+    //
+    // The updates work on a byte per spin, so a run keeps its spins here and
+    // only copies them to a BitLattice to measure or switch move types.
+    class ClusterUpdater {
+    public:
+        ClusterUpdater(int width, int height);
+
+        void load(const BitLattice& lattice);
+        void store(BitLattice& lattice) const;
+
+        // Wolff: grow one cluster from a random seed spin and flip it; returns its size
+        int wolff(double beta, rng::Xoshiro256& random);
+
+        // Wolff updates until as many spins have been flipped as the lattice has
+        // (at least one); returns the number of updates. The stopping point
+        // depends on the clusters, so configurations sampled right after this
+        // are biased: use it while thermalizing to find how many updates make
+        // a sweep, then measure after that fixed number of wolff() calls.
+        int wolff_sweep(double beta, rng::Xoshiro256& random);
+
+        // Swendsen-Wang: bond the whole lattice, label the clusters with a
+        // union-find and flip each cluster with probability 1/2
+        void swendsen_wang(double beta, rng::Xoshiro256& random);
+
+        long long magnetization() const { return total; }
+        long long energy() const;            // Sum of -s_i s_j over the bonds, as BitLattice::energy()
+        long long sites() const { return static_cast<long long>(cols) * rows; }
+
+    private:
+        int cols, rows;
+        std::vector<std::int8_t> spins;
+        long long total = 0;                 // Sum of the spins, kept up to date by the updates
+        std::vector<int> stack;              // Wolff frontier
+        UnionFind clusters;                  // Swendsen-Wang labels
+        std::vector<std::uint8_t> decision;  // Swendsen-Wang: 0 = not drawn yet, 1 = keep, 2 = flip, per root
+    };
+}
+
+#endif
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+g++ -std=c++11 -O2 -fopenmp -o ising main.cpp system.cpp bit_lattice.cpp cluster_moves.cpp analysis.cpp tempering.cpp;
@@ -0,0 +1,223 @@
+#include "system.hpp"
+#include "analysis.hpp"
+#include "bit_lattice.hpp"
+#include "cluster_moves.hpp"
+#include "tempering.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <omp.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    const int WOLFF_CALIBRATION = 100;  // Sweeps that size a Wolff sweep when THERMALIZATION is 0
+
+    // Autocorrelation of a series (all lags by FFT) to path, up to a few
+    // windows past the integrated autocorrelation time; returns that time
+    bool write_autocorrelation(const std::string& path, const std::vector<double>& series, sys::AutocorrelationTime& tau) {
+        std::vector<double> rho = sys::autocorrelation_function(series);
+        tau = sys::integrated_autocorrelation_time(rho);
+
+        std::FILE* file = std::fopen(path.c_str(), "w");
+        if (!file) return false;
+        std::fprintf(file, "# lag \t Autocorrelation\n");
+        int lags = std::min(static_cast<int>(rho.size()), std::max(1000, 2 * tau.window));
+        for (int h = 0; h < lags; h++) std::fprintf(file, "%d\t\t%g\n", h, rho[h]);
+        return std::fclose(file) == 0;
+    }
+
+    void print_tau(const char* name, const sys::AutocorrelationTime& tau) {
+        std::cout << "  tau_int(" << name << ") = " << tau.tau << " sweeps (window " << tau.window << ")";
+        if (!tau.reliable) std::cout << ", the series is too short for the window to close";
+        std::cout << std::endl;
+    }
+
+    int analyze(const std::string& path) {
+        std::vector<double> series;
+        if (!sys::read_series(path, series) || series.empty()) {
+            std::cerr << "Could not read a series from " << path << std::endl;
+            return 1;
+        }
+        sys::BinningAccumulator binning;
+        for (double value : series) binning.add(value);
+        sys::AutocorrelationTime tau;
+        if (!write_autocorrelation("autocorrelation.dat", series, tau)) {
+            std::cerr << "Could not write autocorrelation.dat" << std::endl;
+            return 1;
+        }
+        std::cout << series.size() << " values, mean " << binning.mean() << " +- " << binning.error()
+                  << " (naive " << binning.error(0) << ")" << std::endl;
+        print_tau("series", tau);
+        std::cout << "  tau from binning = " << binning.autocorrelation_time() << std::endl;
+        return 0;
+    }
+
+    int temper(int argc, char* argv[]) {
+        if (argc < 7) {
+            std::cerr << "Usage: " << argv[0] << " --tempering L BETA_MIN BETA_MAX REPLICAS SWEEPS [THERMALIZATION] [SEED] [OUTPUT]"
+                      << std::endl;
+            return 1;
+        }
+        sys::TemperingConfig config;
+        config.size = std::atoi(argv[2]);
+        double low = std::atof(argv[3]), high = std::atof(argv[4]);
+        int replicas = std::atoi(argv[5]);
+        config.sweeps = std::atoi(argv[6]);
+        config.thermalization = argc > 7 ? std::atoi(argv[7]) : config.sweeps / 10;
+        config.seed = argc > 8 ? std::strtoull(argv[8], nullptr, 10) : static_cast<unsigned long long>(time(0));
+        std::string output = argc > 9 ? argv[9] : "tempering.dat";
+        if (config.size < 2 || replicas < 1 || config.sweeps < 1 || config.thermalization < 0 || low < 0 || high < low) {
+            std::cerr << "Need L >= 2, REPLICAS >= 1, SWEEPS >= 1, THERMALIZATION >= 0 and 0 <= BETA_MIN <= BETA_MAX" << std::endl;
+            return 1;
+        }
+        config.betas = sys::beta_ladder(low, high, replicas);
+
+        std::cout << "Seed " << config.seed << ", " << replicas << " replicas of " << config.size << "x" << config.size
+                  << " on " << std::min(replicas, omp_get_max_threads()) << " threads" << std::endl;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<sys::TemperingPoint> points = sys::run_tempering(config);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << replicas << " x " << config.thermalization + config.sweeps << " sweeps in " << seconds << " s" << std::endl;
+
+        for (const sys::TemperingPoint& point : points) {
+            std::cout << "  beta " << point.beta << ": <|m|> = " << point.magnetization.value << " +- " << point.magnetization.error
+                      << ", chi = " << point.susceptibility.value << ", U4 = " << point.binder_cumulant.value
+                      << ", swaps " << point.swap_acceptance << std::endl;
+        }
+        if (!sys::write_tempering_table(output, points)) {
+            std::cerr << "Could not write " << output << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+}
+
+// Usage: ./ising L BETA SWEEPS [THERMALIZATION] [SEED] [MOVE]
+// Runs an L x L lattice from a random start, drops the first THERMALIZATION
+// sweeps (default SWEEPS / 10), and writes the magnetization per spin of
+// every following sweep to magnetization.dat and its autocorrelation to autocorrelation.dat.
+// The observables with their error bars are accumulated as the run goes.
+// MOVE is metropolis (default), wolff (a sweep is the number of Wolff updates
+// that flipped L * L spins per sweep on average during thermalization, or
+// during 100 unmeasured calibration sweeps when THERMALIZATION is 0) or sw
+// (a sweep is one Swendsen-Wang update).
+//
+// ./ising --analyze FILE computes the autocorrelation, its integrated time and
+// the binning error of a series written one value per line.
+//
+// ./ising --tempering L BETA_MIN BETA_MAX REPLICAS SWEEPS [THERMALIZATION] [SEED] [OUTPUT]
+// runs replica exchange (Metropolis sweeps) over REPLICAS evenly spaced
+// values of beta and writes the observables of each to OUTPUT (tempering.dat).
+int main(int argc, char* argv[]) {
+    if (argc == 3 && std::string(argv[1]) == "--analyze") return analyze(argv[2]);
+    if (argc > 1 && std::string(argv[1]) == "--tempering") return temper(argc, argv);
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " L BETA SWEEPS [THERMALIZATION] [SEED] [metropolis|wolff|sw]" << std::endl;
+        std::cerr << "       " << argv[0] << " --analyze FILE" << std::endl;
+        std::cerr << "       " << argv[0] << " --tempering L BETA_MIN BETA_MAX REPLICAS SWEEPS [THERMALIZATION] [SEED] [OUTPUT]" << std::endl;
+        return 1;
+    }
+    int size = std::atoi(argv[1]);
+    double beta = std::atof(argv[2]);
+    int sweeps = std::atoi(argv[3]);
+    int thermalization = argc > 4 ? std::atoi(argv[4]) : sweeps / 10;
+    unsigned long long seed = argc > 5 ? std::strtoull(argv[5], nullptr, 10) : static_cast<unsigned long long>(time(0));
+    std::string move = argc > 6 ? argv[6] : "metropolis";
+    if (move != "metropolis" && move != "wolff" && move != "sw") {
+        std::cerr << "Unknown move " << move << std::endl;
+        return 1;
+    }
+    if (size < 2 || sweeps < 1 || thermalization < 0 || beta < 0) {
+        std::cerr << "Need L >= 2, SWEEPS >= 1, THERMALIZATION >= 0 and BETA >= 0" << std::endl;
+        return 1;
+    }
+
+    rng::Xoshiro256 random(seed);
+    sys::BitLattice lattice(size, size);
+    sys::AcceptanceTable table(beta);
+    lattice.randomize(random);
+    if (move == "metropolis") {
+        std::cout << "Seed " << seed << ", " << (lattice.packed() ? "multispin" : "scalar (L is not a multiple of 128)")
+                  << " updates on " << omp_get_max_threads() << " threads" << std::endl;
+    } else {
+        std::cout << "Seed " << seed << ", " << (move == "sw" ? "Swendsen-Wang" : "Wolff") << " updates" << std::endl;
+    }
+
+    // Cluster moves keep their own copy of the spins, copied back at the end
+    std::unique_ptr<sys::ClusterUpdater> updater;
+    if (move != "metropolis") {
+        updater.reset(new sys::ClusterUpdater(size, size));
+        updater->load(lattice);
+    }
+    long long sweep_index = 0;
+    long long wolff_updates = 0;
+    int wolff_per_sweep = 0;  // Fixed after thermalization
+    auto step = [&]() {
+        if (move == "wolff" && wolff_per_sweep == 0) wolff_updates += updater->wolff_sweep(beta, random);
+        else if (move == "wolff") for (int i = 0; i < wolff_per_sweep; i++) updater->wolff(beta, random);
+        else if (move == "sw") updater->swendsen_wang(beta, random);
+        else lattice.sweep_parallel(table, seed, sweep_index++);
+    };
+    auto magnetization = [&]() { return updater ? updater->magnetization() : lattice.magnetization(); };
+
+    // Sweeps draw from (seed, sweep number), so the run repeats exactly with any OMP_NUM_THREADS
+    auto start = std::chrono::steady_clock::now();
+    for (int sweep = 0; sweep < thermalization; sweep++) step();
+    int calibration = 0;  // Extra unmeasured sweeps to size a Wolff sweep when there was no thermalization
+    if (move == "wolff") {
+        if (thermalization == 0) {
+            calibration = WOLFF_CALIBRATION;
+            for (int sweep = 0; sweep < calibration; sweep++) step();
+        }
+        int sized = thermalization + calibration;
+        wolff_per_sweep = static_cast<int>(std::max(1LL, (wolff_updates + sized / 2) / sized));
+        std::cout << "  " << wolff_per_sweep << " Wolff updates per sweep" << std::endl;
+    }
+
+    // The series of m is kept for its autocorrelation; everything else is accumulated on the fly
+    sys::IsingObservables observables(lattice.sites(), beta);
+    std::vector<double> mag_vec;
+    mag_vec.reserve(sweeps);
+    for (int sweep = 0; sweep < sweeps; sweep++) {
+        step();
+        double m = static_cast<double>(magnetization()) / lattice.sites();
+        double e = static_cast<double>(updater ? updater->energy() : lattice.energy()) / lattice.sites();
+        mag_vec.push_back(m);
+        observables.add(m, e);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (updater) updater->store(lattice);
+
+    double updates = static_cast<double>(lattice.sites()) * (thermalization + calibration + sweeps);
+    std::cout << thermalization + calibration + sweeps << " sweeps of " << size << "x" << size << " in " << seconds << " s ("
+              << updates / seconds / 1e9 << " G spin updates/s)" << std::endl;
+    sys::Estimate m = observables.magnetization(), e = observables.energy();
+    sys::Estimate chi = observables.susceptibility(), heat = observables.specific_heat(), binder = observables.binder_cumulant();
+    std::cout << "  <|m|> = " << m.value << " +- " << m.error << ", <e> = " << e.value << " +- " << e.error << std::endl;
+    std::cout << "  chi = " << chi.value << " +- " << chi.error << ", C = " << heat.value << " +- " << heat.error
+              << ", U4 = " << binder.value << " +- " << binder.error << std::endl;
+
+    std::FILE* file = std::fopen("magnetization.dat", "w");
+    if (!file) {
+        std::cerr << "Could not write magnetization.dat" << std::endl;
+        return 1;
+    }
+    for (double value : mag_vec) std::fprintf(file, "%g\n", value);
+    std::fclose(file);
+
+    sys::AutocorrelationTime tau;
+    if (!write_autocorrelation("autocorrelation.dat", mag_vec, tau)) {
+        std::cerr << "Could not write autocorrelation.dat" << std::endl;
+        return 1;
+    }
+    print_tau("m", tau);
+    std::cout << "  tau from binning: " << observables.tau_magnetization() << " (|m|), " << observables.tau_energy() << " (e)"
+              << std::endl;
+    return 0;
+}
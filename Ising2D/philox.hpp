@@ -0,0 +1,34 @@
+#ifndef PHILOX_HPP
+#define PHILOX_HPP
+#include <array>
+#include <cstdint>
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random
+// numbers: as easy as 1, 2, 3", SC11). The output is a fixed function of a
+// 128-bit counter and a 64-bit key, with no state carried between calls, so
+// any number of threads can draw independent streams just by using different
+// counters: no sharing, no locking and the same numbers whatever the thread count.
+// Ising2D only needs the block function, to seed its per-row Xoshiro generators.
+namespace philox {
+
+    typedef std::array<std::uint32_t, 4> Counter;
+    typedef std::array<std::uint32_t, 2> Key;
+
+    inline Counter block(Counter counter, Key key) {
+        const std::uint32_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u;
+        const std::uint32_t W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+        for (int round = 0; round < 10; ++round) {
+            std::uint64_t product0 = static_cast<std::uint64_t>(M0) * counter[0];
+            std::uint64_t product1 = static_cast<std::uint64_t>(M1) * counter[2];
+            counter = {static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                       static_cast<std::uint32_t>(product1),
+                       static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                       static_cast<std::uint32_t>(product0)};
+            key[0] += W0;
+            key[1] += W1;
+        }
+        return counter;
+    }
+}
+
+#endif
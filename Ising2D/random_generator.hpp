@@ -0,0 +1,75 @@
+#ifndef RANDOM_GENERATOR_HPP
+#define RANDOM_GENERATOR_HPP
+#include <cstdint>
+
+namespace rng{
+
+    // xoshiro256** (Blackman and Vigna): 64 random bits per call from a few
+    // shifts and xors, fast enough to feed the multispin updates
+    class Xoshiro256 {
+    public:
+        explicit Xoshiro256(std::uint64_t seed = 1) { reseed(seed); }
+
+        // Fill the state from seed with splitmix64, so any seed (even 0) gives a good state
+        void reseed(std::uint64_t seed) {
+            for (int i = 0; i < 4; i++) {
+                std::uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                state[i] = z ^ (z >> 31);
+            }
+        }
+
+        // Use 256 bits from elsewhere (e.g. a counter-based generator) as the state
+        void set_state(std::uint64_t s0, std::uint64_t s1, std::uint64_t s2, std::uint64_t s3) {
+            state[0] = (s0 | s1 | s2 | s3) ? s0 : 1; // The all-zero state is a fixed point
+            state[1] = s1;
+            state[2] = s2;
+            state[3] = s3;
+        }
+
+        std::uint64_t next() {
+            std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+            std::uint64_t t = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = rotl(state[3], 45);
+            return result;
+        }
+
+        // Uniform in [0, 1) with 53 random bits
+        double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+        // Uniform in [0, n) for n > 0 (Lemire's multiply and reject)
+        std::uint32_t below(std::uint32_t n) {
+            std::uint64_t product = (next() >> 32) * n;
+            std::uint32_t low = static_cast<std::uint32_t>(product);
+            if (low < n) {
+                std::uint32_t threshold = static_cast<std::uint32_t>(-n) % n;
+                while (low < threshold) {
+                    product = (next() >> 32) * n;
+                    low = static_cast<std::uint32_t>(product);
+                }
+            }
+            return static_cast<std::uint32_t>(product >> 32);
+        }
+
+    private:
+        static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+        std::uint64_t state[4];
+    };
+
+    // The generator behind sys::init_syst and sys::mcmove, which take no generator of their own
+    inline Xoshiro256& global() {
+        static Xoshiro256 generator(1);
+        return generator;
+    }
+
+    inline void seed(std::uint64_t value) { global().reseed(value); }
+}
+
+#endif
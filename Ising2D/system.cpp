@@ -0,0 +1,56 @@
+#include "system.hpp"
+#include "bit_lattice.hpp"
+#include <memory>
+
+namespace sys{
+
+    void init_syst(std::vector<std::vector<int>>& arr, int n, int m) {
+        arr.assign(n, std::vector<int>(m));
+        rng::Xoshiro256& random = rng::global();
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < m; j++) arr[i][j] = random.next() >> 63 ? 1 : -1;
+        }
+    }
+
+    void mcmove(std::vector<std::vector<int>>& config, double beta) {
+        // The sweep runs on a bit lattice; keeping it between calls saves the
+        // allocation, but the spins still go through it on every call, so
+        // long runs should drive a BitLattice directly
+        thread_local std::unique_ptr<BitLattice> lattice;
+        int n = static_cast<int>(config.size());
+        int m = n > 0 ? static_cast<int>(config[0].size()) : 0;
+        if (n == 0 || m == 0) return;
+        if (!lattice || lattice->width() != m || lattice->height() != n) lattice.reset(new BitLattice(m, n));
+
+        lattice->from_config(config);
+        lattice->sweep(AcceptanceTable(beta), rng::global());
+        lattice->to_config(config);
+    }
+
+    double calculate_magnetization(const std::vector<std::vector<int>>& config) {
+        long long sum = 0, count = 0;
+        for (const std::vector<int>& row : config) {
+            for (int spin : row) sum += spin;
+            count += row.size();
+        }
+        return count > 0 ? static_cast<double>(sum) / count : 0.0;
+    }
+
+    double autocorrelation(const std::vector<double>& mag_vec, int h) {
+        // Normalized autocorrelation at lag h: covariance of m_t and m_{t+h} over the variance
+        int n = static_cast<int>(mag_vec.size());
+        if (h < 0 || h >= n) return 0.0;
+        double mu = mean(mag_vec);
+        double variance = 0.0, covariance = 0.0;
+        for (int t = 0; t < n; t++) variance += (mag_vec[t] - mu) * (mag_vec[t] - mu);
+        for (int t = 0; t + h < n; t++) covariance += (mag_vec[t] - mu) * (mag_vec[t + h] - mu);
+        if (variance == 0.0) return 1.0;
+        return (covariance / (n - h)) / (variance / n);
+    }
+
+    double mean(const std::vector<double>& data) {
+        double sum = 0.0;
+        for (double value : data) sum += value;
+        return data.empty() ? 0.0 : sum / data.size();
+    }
+}
@@ -0,0 +1,110 @@
+#include "tempering.hpp"
+#include "bit_lattice.hpp"
+#include <cmath>
+#include <cstdio>
+#include <omp.h>
+#include "philox.hpp"
+
+namespace sys{
+
+    namespace {
+
+        // Seed of the sweeps of replica r, a Philox block of (seed, r) so that
+        // replicas of nearby seeds do not share streams
+        std::uint64_t replica_seed(std::uint64_t seed, int replica) {
+            philox::Key key = {{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)}};
+            philox::Counter counter = {{static_cast<std::uint32_t>(replica), 0x7265706Cu, 0, 0}};
+            philox::Counter block = philox::block(counter, key);
+            return (static_cast<std::uint64_t>(block[0]) << 32) | block[1];
+        }
+    }
+
+    std::vector<TemperingPoint> run_tempering(const TemperingConfig& config) {
+        int count = static_cast<int>(config.betas.size());
+        std::vector<TemperingPoint> points;
+        if (count == 0 || config.size < 2) return points;
+
+        rng::Xoshiro256 random(config.seed);
+        std::vector<BitLattice> lattices(count, BitLattice(config.size, config.size));
+        std::vector<std::uint64_t> seeds(count);
+        for (int r = 0; r < count; r++) {
+            lattices[r].randomize(random);
+            seeds[r] = replica_seed(config.seed, r);
+        }
+
+        // The lattices stay put; replica[k] is the one currently at betas[k]
+        std::vector<int> replica(count);
+        std::vector<AcceptanceTable> tables;
+        std::vector<IsingObservables> observables;
+        for (int k = 0; k < count; k++) {
+            replica[k] = k;
+            tables.push_back(AcceptanceTable(config.betas[k]));
+            observables.push_back(IsingObservables(lattices[0].sites(), config.betas[k]));
+        }
+        std::vector<long long> energies(count);
+        std::vector<long long> sweeps_done(count, 0);
+        std::vector<long long> attempted(count, 0), accepted(count, 0);
+
+        // Each replica is swept by one thread; the sweep's own row loop stays
+        // serial inside, as nested parallel regions are off
+        int threads = config.threads > 0 ? config.threads : omp_get_max_threads();
+        int total = config.thermalization + config.sweeps;
+        for (int sweep = 0; sweep < total; sweep++) {
+            bool measure = sweep >= config.thermalization;
+            #pragma omp parallel for schedule(static) num_threads(threads)
+            for (int k = 0; k < count; k++) {
+                int r = replica[k];
+                lattices[r].sweep_parallel(tables[k], seeds[r], sweeps_done[r]++);
+                energies[k] = lattices[r].energy();
+                if (measure) {
+                    double sites = static_cast<double>(lattices[r].sites());
+                    observables[k].add(lattices[r].magnetization() / sites, energies[k] / sites);
+                }
+            }
+
+            for (int k = sweep % 2; k + 1 < count; k += 2) {
+                double exponent = (config.betas[k] - config.betas[k + 1]) * static_cast<double>(energies[k] - energies[k + 1]);
+                attempted[k]++;
+                if (exponent >= 0.0 || random.uniform() < std::exp(exponent)) {
+                    accepted[k]++;
+                    std::swap(replica[k], replica[k + 1]);
+                    std::swap(energies[k], energies[k + 1]);
+                }
+            }
+        }
+
+        for (int k = 0; k < count; k++) {
+            TemperingPoint point;
+            point.beta = config.betas[k];
+            point.magnetization = observables[k].magnetization();
+            point.susceptibility = observables[k].susceptibility();
+            point.binder_cumulant = observables[k].binder_cumulant();
+            point.energy = observables[k].energy();
+            point.specific_heat = observables[k].specific_heat();
+            point.swap_acceptance = attempted[k] > 0 ? static_cast<double>(accepted[k]) / attempted[k] : 0.0;
+            points.push_back(point);
+        }
+        return points;
+    }
+
+    std::vector<double> beta_ladder(double low, double high, int n) {
+        std::vector<double> betas;
+        for (int k = 0; k < n; k++) betas.push_back(n == 1 ? low : low + (high - low) * k / (n - 1));
+        return betas;
+    }
+
+    bool write_tempering_table(const std::string& path, const std::vector<TemperingPoint>& points) {
+        std::FILE* file = std::fopen(path.c_str(), "w");
+        if (!file) return false;
+
+        std::fprintf(file, "# beta \t |m| \t error \t chi \t error \t U4 \t error \t e \t error \t C \t error \t swap acceptance\n");
+        for (const TemperingPoint& point : points) {
+            std::fprintf(file, "%g\t%g\t%g\t%g\t%g\t%g\t%g\t%g\t%g\t%g\t%g\t%g\n", point.beta,
+                         point.magnetization.value, point.magnetization.error, point.susceptibility.value,
+                         point.susceptibility.error, point.binder_cumulant.value, point.binder_cumulant.error,
+                         point.energy.value, point.energy.error, point.specific_heat.value, point.specific_heat.error,
+                         point.swap_acceptance);
+        }
+        return std::fclose(file) == 0;
+    }
+}
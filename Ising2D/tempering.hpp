@@ -0,0 +1,49 @@
+#ifndef TEMPERING_HPP
+#define TEMPERING_HPP
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "analysis.hpp"
+
+namespace sys{
+
+    // Replica exchange over a ladder of inverse temperatures: one L x L
+    // lattice per beta, all swept at once (a replica per OpenMP thread), with
+    // swaps of neighbouring configurations after every sweep. A configuration
+    // stuck in an ordered state at large beta can walk up to small beta,
+    // decorrelate and come back, and every beta of the curve is sampled in
+    // one run instead of one thermalization per temperature.
+    struct TemperingConfig {
+        int size = 32;
+        std::vector<double> betas;           // Increasing
+        int sweeps = 10000;                  // Measured sweeps per replica
+        int thermalization = 1000;           // Sweeps (with swaps) before measuring
+        std::uint64_t seed = 1;
+        int threads = 0;                     // 0 = OMP_NUM_THREADS or one per core
+    };
+
+    struct TemperingPoint {
+        double beta;
+        Estimate magnetization;              // <|m|>
+        Estimate susceptibility;
+        Estimate binder_cumulant;
+        Estimate energy;                     // Per spin
+        Estimate specific_heat;
+        double swap_acceptance;              // Of swaps with the next beta, 0 for the last
+    };
+
+    // Neighbours k, k+1 swap configurations with probability
+    // min(1, exp((beta_k - beta_k+1) (E_k - E_k+1))), the even pairs after
+    // even sweeps and the odd ones after odd sweeps. Replica r sweeps with
+    // Philox streams of (seed, r) and the swaps draw from the seed alone, so
+    // a run does not depend on the number of threads.
+    std::vector<TemperingPoint> run_tempering(const TemperingConfig& config);
+
+    // n values of beta evenly spaced from low to high
+    std::vector<double> beta_ladder(double low, double high, int n);
+
+    // One line per beta with a # header
+    bool write_tempering_table(const std::string& path, const std::vector<TemperingPoint>& points);
+}
+
+#endif
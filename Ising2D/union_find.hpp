@@ -0,0 +1,47 @@
+#ifndef UNION_FIND_HPP
+#define UNION_FIND_HPP
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace sys{
+
+    // Union-find over the sites for the Swendsen-Wang clusters. A root stores
+    // minus the size of its set, any other site the index of its parent, and
+    // find() halves paths iteratively, so a lattice spanned by one cluster
+    // can not overflow the stack.
+    class UnionFind {
+    public:
+        explicit UnionFind(int n = 0) : parent(n, -1) {}
+
+        // Make every site a set of its own again, keeping the memory
+        void reset() { std::fill(parent.begin(), parent.end(), -1); }
+
+        int find(int x) {
+            while (parent[x] >= 0) {
+                int up = parent[x];
+                if (parent[up] < 0) return up;
+                parent[x] = parent[up];
+                x = parent[up];
+            }
+            return x;
+        }
+
+        // Merge the sets of x and y (the smaller under the larger) and return the root of the result
+        int unite(int x, int y) {
+            int root_x = find(x);
+            int root_y = find(y);
+            if (root_x != root_y) {
+                if (parent[root_x] > parent[root_y]) std::swap(root_x, root_y); // Sizes are negated
+                parent[root_x] += parent[root_y];
+                parent[root_y] = root_x;
+            }
+            return root_x;
+        }
+
+    private:
+        std::vector<int> parent;
+    };
+}
+
+#endif
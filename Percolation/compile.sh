@@ -1,4 +1,4 @@
 #!/bin/bash
 
-g++ -o percolation percolation.cpp -lsfml-graphics -lsfml-window -lsfml-system;
+g++ -O2 -o percolation percolation.cpp hoshen_kopelman.cpp newman_ziff.cpp ensemble.cpp parallel_label.cpp lattice.cpp lattice_renderer.cpp -pthread -lsfml-graphics -lsfml-window -lsfml-system;
 ./percolation
@@ -0,0 +1,144 @@
+#include "ensemble.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include "newman_ziff.hpp"
+
+namespace {
+
+    // Mean and standard error of samples[i * stride + offset] for i < count
+    Estimate estimate(const std::vector<double>& samples, int count, int stride, int offset) {
+        Estimate result;
+        double sum = 0.0;
+        for (int i = 0; i < count; ++i) sum += samples[static_cast<size_t>(i) * stride + offset];
+        result.mean = sum / count;
+        if (count > 1) {
+            double squares = 0.0;
+            for (int i = 0; i < count; ++i) {
+                double deviation = samples[static_cast<size_t>(i) * stride + offset] - result.mean;
+                squares += deviation * deviation;
+            }
+            result.error = std::sqrt(squares / (count - 1) / count);
+        }
+        return result;
+    }
+
+    EnsembleResult runSize(const EnsembleConfig& config, int size, unsigned threads) {
+        const int sites = static_cast<int>(static_cast<long long>(size) * size); // size <= NewmanZiff::MAX_SIZE
+        const int stride = 1 + 3 * config.points; // Threshold, then three values per point
+
+        // The binomial weights only depend on N and p, not on the sweep
+        std::vector<double> ps(config.points);
+        std::vector<BinomialWindow> windows;
+        for (int i = 0; i < config.points; ++i) {
+            ps[i] = config.points > 1 ? config.pMin + (config.pMax - config.pMin) * i / (config.points - 1) : config.pMin;
+            windows.emplace_back(sites, ps[i]);
+        }
+
+        // One row of samples per realization, written by whichever thread ran it
+        std::vector<double> samples(static_cast<size_t>(config.realizations) * stride);
+        std::atomic<int> next(0);
+        auto worker = [&]() {
+            for (int r = next++; r < config.realizations; r = next++) {
+                NewmanZiff sweep(size, config.seed, (static_cast<std::uint64_t>(size) << 32) | static_cast<std::uint32_t>(r));
+                const SweepCurves& curves = sweep.curves();
+                double* row = &samples[static_cast<size_t>(r) * stride];
+                row[0] = static_cast<double>(sweep.firstSpanning()) / sites;
+                for (int i = 0; i < config.points; ++i) {
+                    row[1 + 3 * i] = windows[i].average(curves.spanning);
+                    row[2 + 3 * i] = windows[i].average(curves.largestCluster) / sites;
+                    row[3 + 3 * i] = windows[i].average(curves.meanClusterSize);
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+        worker();
+        for (auto& thread : pool) thread.join();
+
+        EnsembleResult result;
+        result.size = size;
+        result.threshold = estimate(samples, config.realizations, stride, 0);
+        result.thresholdWidth = result.threshold.error * std::sqrt(static_cast<double>(config.realizations));
+        for (int i = 0; i < config.points; ++i) {
+            EnsemblePoint point;
+            point.p = ps[i];
+            point.spanning = estimate(samples, config.realizations, stride, 1 + 3 * i);
+            point.largestFraction = estimate(samples, config.realizations, stride, 2 + 3 * i);
+            point.meanClusterSize = estimate(samples, config.realizations, stride, 3 + 3 * i);
+            result.points.push_back(point);
+        }
+        return result;
+    }
+
+    // Weighted least squares of y = a + b x; returns false if the fit is singular
+    bool fitLine(const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& weight,
+                 double& a, double& b, double& aError) {
+        double s = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+        for (size_t i = 0; i < x.size(); ++i) {
+            s += weight[i];
+            sx += weight[i] * x[i];
+            sy += weight[i] * y[i];
+            sxx += weight[i] * x[i] * x[i];
+            sxy += weight[i] * x[i] * y[i];
+        }
+        double determinant = s * sxx - sx * sx;
+        if (x.size() < 2 || determinant <= 0) return false;
+        a = (sxx * sy - sx * sxy) / determinant;
+        b = (s * sxy - sx * sy) / determinant;
+        aError = std::sqrt(sxx / determinant);
+        return true;
+    }
+}
+
+std::vector<EnsembleResult> runEnsemble(const EnsembleConfig& config) {
+    unsigned threads = config.threads ? config.threads : std::thread::hardware_concurrency();
+    threads = std::max(1u, std::min(threads, static_cast<unsigned>(std::max(1, config.realizations))));
+
+    std::vector<EnsembleResult> results;
+    for (int size : config.sizes) results.push_back(runSize(config, size, threads));
+    return results;
+}
+
+ScalingFit fitThreshold(const std::vector<EnsembleResult>& results, double nu) {
+    ScalingFit fit;
+    fit.nu = nu;
+
+    std::vector<double> x, y, weight, logSize, logWidth, ones;
+    for (const EnsembleResult& result : results) {
+        double error = std::max(result.threshold.error, 1e-12);
+        x.push_back(std::pow(static_cast<double>(result.size), -1.0 / nu));
+        y.push_back(result.threshold.mean);
+        weight.push_back(1.0 / (error * error));
+        if (result.thresholdWidth > 0) {
+            logSize.push_back(std::log(static_cast<double>(result.size)));
+            logWidth.push_back(std::log(result.thresholdWidth));
+            ones.push_back(1.0);
+        }
+    }
+    fit.valid = fitLine(x, y, weight, fit.pc, fit.amplitude, fit.pcError);
+
+    // The width of the transition shrinks as L^(-1/nu)
+    double intercept, slope, unused;
+    if (fitLine(logSize, logWidth, ones, intercept, slope, unused) && slope < 0) fit.widthNu = -1.0 / slope;
+    return fit;
+}
+
+bool writeEnsembleTable(const std::string& path, const std::vector<EnsembleResult>& results) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    std::fprintf(file, "# L \t p \t spanning \t error \t largest/N \t error \t mean_cluster_size \t error\n");
+    for (size_t block = 0; block < results.size(); ++block) {
+        if (block > 0) std::fprintf(file, "\n\n");
+        for (const EnsemblePoint& point : results[block].points) {
+            std::fprintf(file, "%d\t%.6f\t%.6f\t%.6f\t%.6f\t%.6f\t%.6f\t%.6f\n", results[block].size, point.p,
+                         point.spanning.mean, point.spanning.error, point.largestFraction.mean, point.largestFraction.error,
+                         point.meanClusterSize.mean, point.meanClusterSize.error);
+        }
+    }
+    return std::fclose(file) == 0;
+}
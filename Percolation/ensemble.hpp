@@ -0,0 +1,57 @@
+#ifndef ENSEMBLE_HPP
+#define ENSEMBLE_HPP
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Independent Newman-Ziff sweeps for each lattice size, spread over all cores
+struct EnsembleConfig {
+    std::vector<int> sizes;             // Lattice sizes L for finite-size scaling
+    int realizations = 1000;            // Sweeps per size
+    int points = 101;                   // Values of p in [pMin, pMax] for the curves
+    double pMin = 0.5, pMax = 0.7;      // Around the square lattice threshold, 0.5927
+    std::uint64_t seed = 1;
+    unsigned threads = 0;               // 0 = one per core
+};
+
+// Sample mean and its standard error
+struct Estimate {
+    double mean = 0.0;
+    double error = 0.0;
+};
+
+struct EnsemblePoint {
+    double p;
+    Estimate spanning;                  // Spanning probability
+    Estimate largestFraction;           // Largest cluster / N
+    Estimate meanClusterSize;           // Without the largest cluster
+};
+
+struct EnsembleResult {
+    int size;
+    Estimate threshold;                 // Mean of the occupation fraction at which each sweep first spans
+    double thresholdWidth;              // Standard deviation of that fraction over the sweeps
+    std::vector<EnsemblePoint> points;
+};
+
+// Fit of threshold(L) = pc + amplitude * L^(-1/nu) over the sizes, weighted by the errors
+struct ScalingFit {
+    bool valid = false;                 // Needs two or more sizes
+    double pc = 0.0, pcError = 0.0;
+    double amplitude = 0.0;
+    double nu = 0.0;                    // Exponent used in the fit
+    double widthNu = 0.0;               // nu from thresholdWidth ~ L^(-1/nu), 0 if not fitted
+};
+
+// Run all sweeps. Realization r of size L uses Philox stream (L, r) of the
+// seed, and the samples are reduced in realization order, so the results do
+// not depend on the number of threads.
+std::vector<EnsembleResult> runEnsemble(const EnsembleConfig& config);
+
+// Extrapolate the thresholds to L -> infinity; nu = 4/3 is exact in 2D
+ScalingFit fitThreshold(const std::vector<EnsembleResult>& results, double nu = 4.0 / 3.0);
+
+// Write one block per size (separated by blank lines) with a # header
+bool writeEnsembleTable(const std::string& path, const std::vector<EnsembleResult>& results);
+
+#endif
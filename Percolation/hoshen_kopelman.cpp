@@ -0,0 +1,222 @@
+#include "hoshen_kopelman.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+    const long long SMALL_CLUSTER = 4096; // Sizes below this are counted in an array, not the map
+
+    // splitmix64 output function: a bijective mix of 64-bit values
+    std::uint64_t mix(std::uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // splitmix64 stream of one row. It starts at a hash of (seed, row), so the
+    // streams of different rows begin at unrelated points of the 2^64 cycle;
+    // a row only draws width / 2 numbers, so they never overlap in practice.
+    struct RowRandom {
+        std::uint64_t state;
+
+        RowRandom(std::uint64_t seed, long long row) : state(mix(mix(seed) ^ static_cast<std::uint64_t>(row))) {}
+
+        std::uint64_t next() {
+            return mix(state += 0x9E3779B97F4A7C15ull);
+        }
+    };
+}
+
+StreamingLabeler::StreamingLabeler(int width)
+    : width(width), previous(width, -1), current(width, -1), smallSizes(SMALL_CLUSTER, 0) {
+    stats.width = width;
+    parent.reserve(width + 1);
+    clusterSize.reserve(width + 1);
+    edges.reserve(width + 1);
+}
+
+int StreamingLabeler::newLabel(std::uint8_t labelEdges) {
+    int label = static_cast<int>(parent.size());
+    parent.push_back(label);
+    clusterSize.push_back(0);
+    edges.push_back(labelEdges);
+    return label;
+}
+
+int StreamingLabeler::find(int label) {
+    // Path halving: every other node on the way points to its grandparent
+    while (parent[label] != label) {
+        parent[label] = parent[parent[label]];
+        label = parent[label];
+    }
+    return label;
+}
+
+int StreamingLabeler::unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return a;
+    if (clusterSize[a] < clusterSize[b]) std::swap(a, b);
+    parent[b] = a;
+    clusterSize[a] += clusterSize[b];
+    edges[a] |= edges[b];
+    return a;
+}
+
+void StreamingLabeler::closeCluster(int root) {
+    long long size = clusterSize[root];
+    std::uint8_t clusterEdges = edges[root];
+
+    if (size < SMALL_CLUSTER) ++smallSizes[size];
+    else ++stats.histogram[size];
+    ++stats.clusterCount;
+    stats.largestCluster = std::max(stats.largestCluster, size);
+    if ((clusterEdges & TOP) && (clusterEdges & BOTTOM)) {
+        stats.spansVertically = true;
+        stats.largestSpanning = std::max(stats.largestSpanning, size);
+    }
+    if ((clusterEdges & LEFT) && (clusterEdges & RIGHT)) stats.spansHorizontally = true;
+}
+
+void StreamingLabeler::addRow(const std::uint8_t* occupied) {
+    std::uint8_t rowEdges = stats.height == 0 ? TOP : 0;
+
+    // A horizontal run of occupied sites is one cluster, joined with every
+    // cluster above it; the row above usually repeats a label over many sites,
+    // so only changes of that label cost a union.
+    int x = 0;
+    while (x < width) {
+        if (!occupied[x]) {
+            current[x++] = -1;
+            continue;
+        }
+
+        int start = x;
+        int label = -1;
+        int lastUp = -1;
+        for (; x < width && occupied[x]; ++x) {
+            int up = previous[x];
+            if (up >= 0 && up != lastUp) {
+                label = label < 0 ? find(up) : unite(label, up);
+                lastUp = up;
+            }
+        }
+        if (label < 0) label = newLabel(0);
+
+        clusterSize[label] += x - start;
+        edges[label] |= rowEdges | (start == 0 ? LEFT : 0) | (x == width ? RIGHT : 0);
+        std::fill(current.begin() + start, current.begin() + x, label);
+        stats.occupiedSites += x - start;
+    }
+
+    ++stats.height;
+    compact();
+    previous.swap(current);
+}
+
+void StreamingLabeler::compact() {
+    int count = static_cast<int>(parent.size());
+    remap.assign(count, -1);
+
+    // Renumber the clusters present in the current row 0..k-1, in order of appearance
+    keptSize.clear();
+    keptEdges.clear();
+    int lastLabel = -1, lastKept = -1;
+    for (int x = 0; x < width; ++x) {
+        int label = current[x];
+        if (label < 0) continue;
+        if (label != lastLabel) { // Once per run
+            int root = find(label);
+            if (remap[root] < 0) {
+                remap[root] = static_cast<int>(keptSize.size());
+                keptSize.push_back(clusterSize[root]);
+                keptEdges.push_back(edges[root]);
+            }
+            lastLabel = label;
+            lastKept = remap[root];
+        }
+        current[x] = lastKept;
+    }
+
+    // Every other cluster has no site in this row, so it is complete
+    for (int label = 0; label < count; ++label) {
+        if (parent[label] == label && remap[label] < 0) closeCluster(label);
+    }
+
+    int kept = static_cast<int>(keptSize.size());
+    parent.resize(kept);
+    for (int label = 0; label < kept; ++label) parent[label] = label;
+    clusterSize.swap(keptSize);
+    edges.swap(keptEdges);
+}
+
+ClusterStats StreamingLabeler::finish() {
+    // What is left touches the last row
+    for (int label = 0; label < static_cast<int>(parent.size()); ++label) {
+        edges[label] |= BOTTOM;
+        closeCluster(label);
+    }
+    parent.clear();
+    clusterSize.clear();
+    edges.clear();
+    std::fill(previous.begin(), previous.end(), -1);
+
+    for (long long size = 1; size < SMALL_CLUSTER; ++size) {
+        if (smallSizes[size] > 0) stats.histogram[size] = smallSizes[size];
+    }
+    std::fill(smallSizes.begin(), smallSizes.end(), 0);
+
+    ClusterStats result = stats;
+    stats = ClusterStats();
+    stats.width = width;
+    return result;
+}
+
+void randomRow(int width, double p, std::uint64_t seed, long long row, std::uint8_t* occupied) {
+    // A site is occupied when 32 random bits are below p * 2^32
+    const std::uint64_t threshold = static_cast<std::uint64_t>(std::max(0.0, std::min(1.0, p)) * 4294967296.0);
+    RowRandom random(seed, row);
+    for (int x = 0; x < width; x += 2) {
+        std::uint64_t bits = random.next();
+        occupied[x] = (bits & 0xFFFFFFFFull) < threshold;
+        if (x + 1 < width) occupied[x + 1] = (bits >> 32) < threshold;
+    }
+}
+
+ClusterStats labelRandomLattice(int width, long long height, double p, std::uint64_t seed) {
+    StreamingLabeler labeler(width);
+    std::vector<std::uint8_t> row(width);
+    for (long long y = 0; y < height; ++y) {
+        randomRow(width, p, seed, y, row.data());
+        labeler.addRow(row.data());
+    }
+    return labeler.finish();
+}
+
+bool labelLatticeFile(const std::string& path, int width, ClusterStats& stats) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    StreamingLabeler labeler(width);
+    std::vector<std::uint8_t> row(width);
+    size_t got;
+    while ((got = std::fread(row.data(), 1, width, file)) == static_cast<size_t>(width)) {
+        labeler.addRow(row.data());
+    }
+    bool ok = got == 0 && !std::ferror(file); // No partial last row
+    std::fclose(file);
+
+    stats = labeler.finish();
+    return ok;
+}
+
+bool writeHistogram(const std::string& path, const ClusterStats& stats) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    std::fprintf(file, "# %lldx%lld lattice, %lld occupied sites, %lld clusters\n",
+                 stats.width, stats.height, stats.occupiedSites, stats.clusterCount);
+    std::fprintf(file, "# size \t count\n");
+    for (const auto& entry : stats.histogram) std::fprintf(file, "%lld\t%lld\n", entry.first, entry.second);
+    return std::fclose(file) == 0;
+}
@@ -0,0 +1,76 @@
+#ifndef HOSHEN_KOPELMAN_HPP
+#define HOSHEN_KOPELMAN_HPP
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Statistics of all clusters of a labelled lattice
+struct ClusterStats {
+    long long width = 0, height = 0;
+    long long occupiedSites = 0;
+    long long clusterCount = 0;
+    long long largestCluster = 0;
+    long long largestSpanning = 0;            // Largest cluster touching the top and bottom rows, 0 if none
+    bool spansVertically = false;             // Some cluster touches the top and bottom rows
+    bool spansHorizontally = false;           // Some cluster touches the left and right columns
+    std::map<long long, long long> histogram; // Cluster size -> number of clusters of that size
+};
+
+// Hoshen-Kopelman labelling of a 2D site lattice (4 neighbours, open
+// boundaries) that is fed one row at a time.
+//
+// Only the labels of the previous and the current row are kept. After each
+// row the labels still present are renumbered 0..k-1 and the label
+// equivalence table is rebuilt with just those, so memory is O(width) whatever
+// the height. A cluster with no site in the current row can not grow any
+// more; its size goes into the histogram as soon as that is known. Lattices
+// far larger than memory can be labelled from a generator or a file.
+class StreamingLabeler {
+public:
+    explicit StreamingLabeler(int width);
+
+    // Label the next row; occupied[x] != 0 for occupied sites, width entries
+    void addRow(const std::uint8_t* occupied);
+
+    // Close the lattice after the last row and return the statistics
+    ClusterStats finish();
+
+private:
+    enum Edge : std::uint8_t { TOP = 1, BOTTOM = 2, LEFT = 4, RIGHT = 8 };
+
+    int newLabel(std::uint8_t edges);
+    int find(int label);
+    int unite(int a, int b);
+    void closeCluster(int root);
+    void compact();
+
+    int width;
+    ClusterStats stats;
+    std::vector<int> previous, current;   // Labels of the last two rows, -1 = empty site
+    std::vector<int> parent;              // Label equivalences of the clusters in those rows
+    std::vector<long long> clusterSize;   // Valid for roots
+    std::vector<std::uint8_t> edges;      // Lattice edges touched, valid for roots
+    std::vector<int> remap;               // Scratch for compact()
+    std::vector<long long> keptSize;      // Scratch for compact()
+    std::vector<std::uint8_t> keptEdges;  // Scratch for compact()
+    std::vector<long long> smallSizes;    // Histogram of the many small clusters, merged into stats at the end
+};
+
+// Fill row `row` of a random lattice: each of the width sites is occupied
+// with probability p, from a generator seeded by a hash of (seed, row)
+void randomRow(int width, double p, std::uint64_t seed, long long row, std::uint8_t* occupied);
+
+// Label a width x height lattice whose sites are occupied with probability p.
+// The rows are generated as they are labelled (randomRow), so nothing of the
+// lattice is stored.
+ClusterStats labelRandomLattice(int width, long long height, double p, std::uint64_t seed);
+
+// Label a lattice stored as one byte per site, row by row, read in a stream.
+// The height is the file size divided by the width.
+bool labelLatticeFile(const std::string& path, int width, ClusterStats& stats);
+
+// Write the histogram as "size count" lines under a # header
+bool writeHistogram(const std::string& path, const ClusterStats& stats);
+
+#endif
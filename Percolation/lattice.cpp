@@ -0,0 +1,37 @@
+#include "lattice.hpp"
+
+namespace {
+
+    template <typename Lattice>
+    LatticeStats percolate(bool bonds, int size, double p, std::uint64_t seed) {
+        Box box = lattice::cube<Lattice>(size);
+        return bonds ? lattice::bondPercolation<Lattice>(box, p, seed) : lattice::sitePercolation<Lattice>(box, p, seed);
+    }
+}
+
+long long latticeSites(const std::string& name, int size) {
+    if (name == "square" || name == "triangular" || name == "honeycomb") return lattice::cube<lattice::Square>(size).sites();
+    if (name == "cubic") return lattice::cube<lattice::Cubic>(size).sites();
+    return 0;
+}
+
+bool percolateLattice(const std::string& name, bool bonds, int size, double p, std::uint64_t seed,
+                      LatticeStats& stats, double& knownThreshold) {
+    // The one choice made at run time; everything below it is specialized per lattice
+    if (name == "square") {
+        stats = percolate<lattice::Square>(bonds, size, p, seed);
+        knownThreshold = bonds ? 0.5 : 0.592746;
+    } else if (name == "triangular") {
+        stats = percolate<lattice::Triangular>(bonds, size, p, seed);
+        knownThreshold = bonds ? 0.347296 : 0.5;
+    } else if (name == "honeycomb") {
+        stats = percolate<lattice::Honeycomb>(bonds, size, p, seed);
+        knownThreshold = bonds ? 0.652704 : 0.697043;
+    } else if (name == "cubic") {
+        stats = percolate<lattice::Cubic>(bonds, size, p, seed);
+        knownThreshold = bonds ? 0.248812 : 0.311608;
+    } else {
+        return false;
+    }
+    return true;
+}
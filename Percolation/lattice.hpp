@@ -0,0 +1,172 @@
+#ifndef LATTICE_HPP
+#define LATTICE_HPP
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "philox.hpp"
+#include "union_find.hpp"
+
+// Extent of a lattice; sites are numbered x + width * (y + height * z).
+// The labelling indexes sites with int, so sites() must stay <= INT_MAX.
+struct Box {
+    int width, height, depth; // depth = 1 for 2D lattices
+
+    long long sites() const { return static_cast<long long>(width) * height * depth; }
+};
+
+// Lattices as neighbourhood stencils. Each one lists the bonds from a site
+// to the neighbours that come after it (so every bond is visited once) with
+// open boundaries, through visit(neighbour, bond), where bond is 0..BONDS-1.
+// The stencil is a template parameter of the labelling loops below, so each
+// lattice gets its own fully inlined loop without virtual calls.
+namespace lattice {
+
+    // 4 neighbours
+    struct Square {
+        static const int DIMENSIONS = 2;
+        static const int BONDS = 2;
+
+        template <typename Visit>
+        static void forwardBonds(const Box& box, int x, int y, int, int site, Visit visit) {
+            if (x + 1 < box.width) visit(site + 1, 0);
+            if (y + 1 < box.height) visit(site + box.width, 1);
+        }
+    };
+
+    // 6 neighbours: the square lattice with one diagonal in every square
+    struct Triangular {
+        static const int DIMENSIONS = 2;
+        static const int BONDS = 3;
+
+        template <typename Visit>
+        static void forwardBonds(const Box& box, int x, int y, int, int site, Visit visit) {
+            if (x + 1 < box.width) visit(site + 1, 0);
+            if (y + 1 < box.height) {
+                visit(site + box.width, 1);
+                if (x + 1 < box.width) visit(site + box.width + 1, 2);
+            }
+        }
+    };
+
+    // 3 neighbours, as the brick wall: the square lattice with every other vertical bond left out
+    struct Honeycomb {
+        static const int DIMENSIONS = 2;
+        static const int BONDS = 2;
+
+        template <typename Visit>
+        static void forwardBonds(const Box& box, int x, int y, int, int site, Visit visit) {
+            if (x + 1 < box.width) visit(site + 1, 0);
+            if (y + 1 < box.height && (x + y) % 2 == 0) visit(site + box.width, 1);
+        }
+    };
+
+    // 6 neighbours in 3D
+    struct Cubic {
+        static const int DIMENSIONS = 3;
+        static const int BONDS = 3;
+
+        template <typename Visit>
+        static void forwardBonds(const Box& box, int x, int y, int z, int site, Visit visit) {
+            if (x + 1 < box.width) visit(site + 1, 0);
+            if (y + 1 < box.height) visit(site + box.width, 1);
+            if (z + 1 < box.depth) visit(site + box.width * box.height, 2);
+        }
+    };
+}
+
+// Clusters of one random configuration
+struct LatticeStats {
+    long long clusters = 0;
+    long long largestCluster = 0;
+    bool spans = false; // A cluster joins the first and last layer along the last axis (y in 2D, z in 3D)
+};
+
+namespace lattice {
+
+    // Box of side size in the dimensions of the lattice
+    template <typename Lattice>
+    Box cube(int size) {
+        return Box{size, size, Lattice::DIMENSIONS == 3 ? size : 1};
+    }
+
+    // Count the clusters of the occupied sites after the unions
+    inline LatticeStats clusterStats(const Box& box, const std::vector<std::uint8_t>& occupied, UnionFind& uf) {
+        LatticeStats stats;
+        const int sites = static_cast<int>(box.sites());
+        const int layer = box.depth > 1 ? box.width * box.height : box.width;
+
+        for (int site = 0; site < sites; ++site) {
+            if (occupied[site] && uf.isRoot(site)) {
+                ++stats.clusters;
+                stats.largestCluster = std::max<long long>(stats.largestCluster, uf.setSize(site));
+            }
+        }
+
+        std::vector<std::uint8_t> inFirstLayer(sites, 0);
+        for (int site = 0; site < layer; ++site) {
+            if (occupied[site]) inFirstLayer[uf.find(site)] = 1;
+        }
+        for (int site = sites - layer; site < sites && !stats.spans; ++site) {
+            stats.spans = occupied[site] && inFirstLayer[uf.find(site)];
+        }
+        return stats;
+    }
+
+    // Site percolation: each site is occupied with probability p, and occupied neighbours are connected
+    template <typename Lattice>
+    LatticeStats sitePercolation(const Box& box, double p, std::uint64_t seed) {
+        const std::uint64_t threshold = static_cast<std::uint64_t>(std::max(0.0, std::min(1.0, p)) * 4294967296.0);
+        const int sites = static_cast<int>(box.sites());
+        PhiloxStream random(seed, 0);
+        std::vector<std::uint8_t> occupied(sites);
+        for (int site = 0; site < sites; ++site) occupied[site] = random() < threshold;
+
+        UnionFind uf(sites);
+        int site = 0;
+        for (int z = 0; z < box.depth; ++z) {
+            for (int y = 0; y < box.height; ++y) {
+                for (int x = 0; x < box.width; ++x, ++site) {
+                    if (!occupied[site]) continue;
+                    Lattice::forwardBonds(box, x, y, z, site, [&](int neighbour, int) {
+                        if (occupied[neighbour]) uf.unite(site, neighbour);
+                    });
+                }
+            }
+        }
+        return clusterStats(box, occupied, uf);
+    }
+
+    // Bond percolation: every site is present and each bond is open with probability p
+    template <typename Lattice>
+    LatticeStats bondPercolation(const Box& box, double p, std::uint64_t seed) {
+        const std::uint64_t threshold = static_cast<std::uint64_t>(std::max(0.0, std::min(1.0, p)) * 4294967296.0);
+        const int sites = static_cast<int>(box.sites());
+        PhiloxStream random(seed, 1);
+        std::vector<std::uint8_t> occupied(sites, 1);
+
+        UnionFind uf(sites);
+        int site = 0;
+        for (int z = 0; z < box.depth; ++z) {
+            for (int y = 0; y < box.height; ++y) {
+                for (int x = 0; x < box.width; ++x, ++site) {
+                    Lattice::forwardBonds(box, x, y, z, site, [&](int neighbour, int) {
+                        if (random() < threshold) uf.unite(site, neighbour);
+                    });
+                }
+            }
+        }
+        return clusterStats(box, occupied, uf);
+    }
+}
+
+// Number of sites of the lattice given by name of side size, 0 for unknown names
+long long latticeSites(const std::string& name, int size);
+
+// Run site or bond percolation on a lattice given by name (square,
+// triangular, honeycomb or cubic) of side size. False for unknown names.
+// latticeSites(name, size) must not exceed INT_MAX.
+bool percolateLattice(const std::string& name, bool bonds, int size, double p, std::uint64_t seed,
+                      LatticeStats& stats, double& knownThreshold);
+
+#endif
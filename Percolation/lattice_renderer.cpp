@@ -0,0 +1,78 @@
+#include "lattice_renderer.hpp"
+#include <algorithm>
+
+namespace {
+
+    const float MIN_VISIBLE_SITES = 8.0f;  // Zooming in stops when the view is this many sites wide
+    const float MIN_GRID_LINE_CELL = 4.0f; // Pixels a cell needs on screen before its outline is drawn
+}
+
+LatticeRenderer::LatticeRenderer(int gridSize, int size, sf::Vector2u windowSize)
+    : gridSize(gridSize), size(size), pixels(static_cast<size_t>(gridSize) * gridSize * 4, 255), gridLines(sf::Lines) {
+    texture.create(gridSize, gridSize);
+    texture.setSmooth(false);
+    sprite.setTexture(texture, true);
+
+    // One line per row and column boundary, all in a single vertex array
+    for (int i = 0; i <= gridSize; i++) {
+        float at = static_cast<float>(i);
+        gridLines.append(sf::Vertex(sf::Vector2f(at, 0.f), sf::Color::Black));
+        gridLines.append(sf::Vertex(sf::Vector2f(at, static_cast<float>(gridSize)), sf::Color::Black));
+        gridLines.append(sf::Vertex(sf::Vector2f(0.f, at), sf::Color::Black));
+        gridLines.append(sf::Vertex(sf::Vector2f(static_cast<float>(gridSize), at), sf::Color::Black));
+    }
+    view.setViewport(sf::FloatRect(0.f, 0.f, static_cast<float>(size) / windowSize.x, static_cast<float>(size) / windowSize.y));
+    reset();
+}
+
+void LatticeRenderer::update(const std::vector<bool>& occupied, UnionFind& uf, const std::vector<sf::Color>& clusterColors) {
+    std::uint8_t* pixel = pixels.data();
+    for (int index = 0; index < gridSize * gridSize; index++, pixel += 4) {
+        sf::Color color = occupied[index] ? clusterColors[uf.find(index)] : sf::Color::White;
+        pixel[0] = color.r;
+        pixel[1] = color.g;
+        pixel[2] = color.b;
+        pixel[3] = 255;
+    }
+    texture.update(pixels.data());
+}
+
+void LatticeRenderer::zoom(float factor, sf::Vector2i pixel, const sf::RenderTarget& target) {
+    sf::Vector2f before = target.mapPixelToCoords(pixel, view);
+    // A lattice narrower than MIN_VISIBLE_SITES can only be shown whole
+    float narrowest = std::min(MIN_VISIBLE_SITES, static_cast<float>(gridSize));
+    float width = std::max(narrowest, std::min(static_cast<float>(gridSize), view.getSize().x * factor));
+    view.setSize(width, width);
+    view.move(before - target.mapPixelToCoords(pixel, view));
+    clampView();
+}
+
+void LatticeRenderer::drag(sf::Vector2i from, sf::Vector2i to, const sf::RenderTarget& target) {
+    view.move(target.mapPixelToCoords(from, view) - target.mapPixelToCoords(to, view));
+    clampView();
+}
+
+void LatticeRenderer::reset() {
+    view.reset(sf::FloatRect(0.f, 0.f, static_cast<float>(gridSize), static_cast<float>(gridSize)));
+}
+
+bool LatticeRenderer::contains(sf::Vector2i pixel) const {
+    return pixel.x >= 0 && pixel.y >= 0 && pixel.x < size && pixel.y < size;
+}
+
+void LatticeRenderer::clampView() {
+    // Keep the lattice under the whole view
+    float half = view.getSize().x / 2;
+    sf::Vector2f center = view.getCenter();
+    center.x = std::max(half, std::min(gridSize - half, center.x));
+    center.y = std::max(half, std::min(gridSize - half, center.y));
+    view.setCenter(center);
+}
+
+void LatticeRenderer::draw(sf::RenderTarget& target) {
+    sf::View previous = target.getView();
+    target.setView(view);
+    target.draw(sprite);
+    if (size / view.getSize().x >= MIN_GRID_LINE_CELL) target.draw(gridLines);
+    target.setView(previous);
+}
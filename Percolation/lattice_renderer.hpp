@@ -0,0 +1,50 @@
+#ifndef LATTICE_RENDERER_HPP
+#define LATTICE_RENDERER_HPP
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+#include "union_find.hpp"
+
+// Draws a gridSize x gridSize lattice as one texture with a texel per site.
+//
+// update() colors the sites into an RGBA buffer and uploads it once, so a
+// frame costs a single sprite draw whatever the lattice size, and nothing is
+// looked up in the union-find between changes. The lattice has its own view
+// in the top size x size pixels of the window, which can be zoomed and panned
+// for lattices with more sites than pixels; the grid lines of the original
+// display are drawn only where cells are large enough to see them.
+class LatticeRenderer {
+public:
+    // The lattice area is the top-left size x size pixels of a window of windowSize
+    LatticeRenderer(int gridSize, int size, sf::Vector2u windowSize);
+
+    // Recolor every site: occupied sites take the color of their cluster root, empty sites are white
+    void update(const std::vector<bool>& occupied, UnionFind& uf, const std::vector<sf::Color>& clusterColors);
+
+    // Zoom by factor (< 1 zooms in) keeping the site under the window pixel in place
+    void zoom(float factor, sf::Vector2i pixel, const sf::RenderTarget& target);
+
+    // Move the lattice along with a mouse drag from one window pixel to another
+    void drag(sf::Vector2i from, sf::Vector2i to, const sf::RenderTarget& target);
+
+    // Show the whole lattice again
+    void reset();
+
+    // True if the window pixel lies on the lattice area
+    bool contains(sf::Vector2i pixel) const;
+
+    void draw(sf::RenderTarget& target);
+
+private:
+    void clampView();
+
+    int gridSize;
+    int size;                         // Pixels along each side of the lattice area
+    std::vector<std::uint8_t> pixels; // RGBA, one pixel per site
+    sf::Texture texture;
+    sf::Sprite sprite;
+    sf::View view;                    // In sites, so a site is one unit
+    sf::VertexArray gridLines;
+};
+
+#endif
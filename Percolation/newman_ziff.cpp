@@ -0,0 +1,142 @@
+#include "newman_ziff.hpp"
+#include <algorithm>
+#include <cstdio>
+#include "philox.hpp"
+
+namespace {
+
+    enum Edge : std::uint8_t { TOP = 1, BOTTOM = 2 };
+
+    // Call visit(neighbour) for the occupied 4-neighbours of site
+    template <typename Visit>
+    void forOccupiedNeighbours(int site, int size, const std::vector<bool>& occupied, Visit visit) {
+        int x = site % size;
+        int y = site / size;
+        if (x > 0 && occupied[site - 1]) visit(site - 1);
+        if (x + 1 < size && occupied[site + 1]) visit(site + 1);
+        if (y > 0 && occupied[site - size]) visit(site - size);
+        if (y + 1 < size && occupied[site + size]) visit(site + size);
+    }
+}
+
+NewmanZiff::NewmanZiff(int size, std::uint64_t seed, std::uint64_t stream)
+    : latticeSize(size), spanningFrom(0), order(static_cast<size_t>(sites())) {
+    // Fisher-Yates shuffle of the site indices
+    PhiloxStream random(seed, stream);
+    const int count = static_cast<int>(sites());
+    for (int i = 0; i < count; ++i) order[i] = i;
+    for (int i = count - 1; i > 0; --i) std::swap(order[i], order[random.below(i + 1)]);
+    run();
+}
+
+void NewmanZiff::run() {
+    const int count = static_cast<int>(sites());
+    UnionFind uf(count);
+    std::vector<bool> occupied(count, false);
+    std::vector<std::uint8_t> edges(count, 0); // Rows touched, valid for roots
+
+    sweep.spanning.assign(count + 1, 0.0);
+    sweep.largestCluster.assign(count + 1, 0.0);
+    sweep.meanClusterSize.assign(count + 1, 0.0);
+
+    // Sum of the squared cluster sizes: a merge of sizes a and b adds 2ab
+    long long sumSquares = 0;
+    long long largest = 0;
+    bool spans = false;
+
+    for (int n = 0; n < count; ++n) {
+        int site = order[n];
+        int y = site / latticeSize;
+        occupied[site] = true;
+        edges[site] = (y == 0 ? TOP : 0) | (y == latticeSize - 1 ? BOTTOM : 0);
+        ++sumSquares;
+
+        int root = site;
+        forOccupiedNeighbours(site, latticeSize, occupied, [&](int neighbour) {
+            int a = uf.find(root);
+            int b = uf.find(neighbour);
+            if (a == b) return;
+            sumSquares += 2LL * uf.setSize(a) * uf.setSize(b);
+            std::uint8_t merged = edges[a] | edges[b];
+            root = uf.unite(a, b);
+            edges[root] = merged;
+        });
+        root = uf.find(root);
+
+        largest = std::max<long long>(largest, uf.setSize(root));
+        if (!spans && edges[root] == (TOP | BOTTOM)) {
+            spans = true;
+            spanningFrom = n + 1;
+        }
+
+        int occupiedSites = n + 1;
+        sweep.spanning[occupiedSites] = spans ? 1.0 : 0.0;
+        sweep.largestCluster[occupiedSites] = static_cast<double>(largest);
+        if (occupiedSites > largest) {
+            sweep.meanClusterSize[occupiedSites] = static_cast<double>(sumSquares - largest * largest) / (occupiedSites - largest);
+        }
+    }
+}
+
+void NewmanZiff::replay(int from, int to, std::vector<bool>& occupied, UnionFind& uf) const {
+    for (int n = from; n < to; ++n) {
+        int site = order[n];
+        occupied[site] = true;
+        forOccupiedNeighbours(site, latticeSize, occupied, [&](int neighbour) { uf.unite(site, neighbour); });
+    }
+}
+
+BinomialWindow::BinomialWindow(int count, double p) {
+    if (p <= 0.0 || p >= 1.0) {
+        first = p <= 0.0 ? 0 : count;
+        weights.assign(1, 1.0);
+        return;
+    }
+
+    // Start at the most likely n with weight 1 and walk outwards with the
+    // ratio of neighbouring binomial terms, until the weights are negligible
+    const double CUTOFF = 1e-15;
+    int mode = std::min(count, static_cast<int>(p * (count + 1)));
+    std::vector<double> below;
+    double weight = 1.0;
+    for (int n = mode; n > 0 && weight > CUTOFF; --n) {
+        weight *= static_cast<double>(n) / (count - n + 1) * (1.0 - p) / p;
+        below.push_back(weight);
+    }
+    first = mode - static_cast<int>(below.size());
+    weights.assign(below.rbegin(), below.rend());
+    weights.push_back(1.0);
+    weight = 1.0;
+    for (int n = mode; n < count && weight > CUTOFF; ++n) {
+        weight *= static_cast<double>(count - n) / (n + 1) * p / (1.0 - p);
+        weights.push_back(weight);
+    }
+
+    double total = 0.0;
+    for (double w : weights) total += w;
+    for (double& w : weights) w /= total;
+}
+
+double BinomialWindow::average(const std::vector<double>& curve) const {
+    double sum = 0.0;
+    for (size_t i = 0; i < weights.size(); ++i) sum += weights[i] * curve[first + i];
+    return sum;
+}
+
+double atProbability(const std::vector<double>& curve, double p) {
+    return BinomialWindow(static_cast<int>(curve.size()) - 1, p).average(curve);
+}
+
+bool writeSweepCurves(const std::string& path, const SweepCurves& curves, int points) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    double sites = static_cast<double>(curves.spanning.size() - 1);
+    std::fprintf(file, "# p \t spanning \t largest/N \t mean_cluster_size\n");
+    for (int i = 0; i < points; ++i) {
+        double p = points > 1 ? static_cast<double>(i) / (points - 1) : 0.0;
+        std::fprintf(file, "%.6f\t%.6f\t%.6f\t%.6f\n", p, atProbability(curves.spanning, p),
+                     atProbability(curves.largestCluster, p) / sites, atProbability(curves.meanClusterSize, p));
+    }
+    return std::fclose(file) == 0;
+}
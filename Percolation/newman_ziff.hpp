@@ -0,0 +1,75 @@
+#ifndef NEWMAN_ZIFF_HPP
+#define NEWMAN_ZIFF_HPP
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "union_find.hpp"
+
+// Observables of a sweep over the occupation number n = 0..N (N = size * size),
+// one entry per n. For a single sweep spanning is 0 or 1; averaged over many
+// sweeps the entries become probabilities and means.
+struct SweepCurves {
+    std::vector<double> spanning;        // A cluster joins the top and bottom rows
+    std::vector<double> largestCluster;  // Sites in the largest cluster
+    std::vector<double> meanClusterSize; // sum s^2 / sum s over all clusters but the largest
+};
+
+// Newman-Ziff sweep of site percolation on a size x size square lattice.
+//
+// The sites are occupied one at a time in a random order, each uniting with
+// its occupied neighbours, so the lattice passes through every occupation
+// number n once. The observables are updated per added site in O(alpha(N)),
+// which gives them for all n in one pass instead of one labelling per p.
+// Curves at a probability p follow by averaging over n with binomial weights.
+class NewmanZiff {
+public:
+    // Sites are indexed with int, so size must be at most MAX_SIZE
+    static const int MAX_SIZE = 46340;
+
+    // The order comes from Philox stream `stream` of seed, so sweeps with
+    // different streams are independent and can run on any thread
+    NewmanZiff(int size, std::uint64_t seed, std::uint64_t stream = 0);
+
+    int size() const { return latticeSize; }
+    long long sites() const { return static_cast<long long>(latticeSize) * latticeSize; }
+    const SweepCurves& curves() const { return sweep; }
+
+    // Smallest n at which the lattice spans top to bottom
+    int firstSpanning() const { return spanningFrom; }
+
+    // Occupy the sites added between occupation numbers from and to (from <= to)
+    // in occupied/uf, which must hold the lattice at occupation number from
+    void replay(int from, int to, std::vector<bool>& occupied, UnionFind& uf) const;
+
+    // Index of the site added as the (n+1)-th
+    int site(int n) const { return order[n]; }
+
+private:
+    void run();
+
+    int latticeSize;
+    int spanningFrom;
+    std::vector<int> order; // Random permutation of the sites
+    SweepCurves sweep;
+};
+
+// Probabilities of n of `count` sites being occupied at probability p, for the
+// n around the mode that matter; the negligible tails are left out
+struct BinomialWindow {
+    int first;                   // n of weights[0]
+    std::vector<double> weights; // Normalized to sum 1
+
+    BinomialWindow(int count, double p);
+
+    // Average of curve[n] over the window
+    double average(const std::vector<double>& curve) const;
+};
+
+// Average a curve over n with the binomial weights of N sites occupied with
+// probability p, i.e. its value at p in the usual canonical ensemble
+double atProbability(const std::vector<double>& curve, double p);
+
+// Write the curves sampled at `points` equally spaced p in [0, 1] as a table with a # header
+bool writeSweepCurves(const std::string& path, const SweepCurves& curves, int points);
+
+#endif
@@ -0,0 +1,94 @@
+#include "parallel_label.hpp"
+#include <algorithm>
+#include <thread>
+#include "philox.hpp"
+#include "union_find.hpp"
+
+namespace {
+
+    unsigned threadCount(unsigned threads, int height) {
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        return std::max(1u, std::min(threads, static_cast<unsigned>(std::max(1, height))));
+    }
+
+    // Run strip(index, firstRow, endRow) for equal strips of rows on their own threads
+    template <typename Strip>
+    void forStrips(int height, unsigned strips, Strip strip) {
+        auto run = [&](unsigned index) {
+            int first = static_cast<int>(static_cast<long long>(height) * index / strips);
+            int end = static_cast<int>(static_cast<long long>(height) * (index + 1) / strips);
+            strip(index, first, end);
+        };
+        std::vector<std::thread> pool;
+        for (unsigned index = 1; index < strips; ++index) pool.emplace_back(run, index);
+        run(0);
+        for (auto& thread : pool) thread.join();
+    }
+}
+
+void labelParallel(const std::vector<std::uint8_t>& occupied, int width, int height,
+                   std::vector<int>& labels, unsigned threads) {
+    const unsigned strips = threadCount(threads, height);
+    ConcurrentUnionFind<int> uf(width * height, false); // Each strip initializes its own sites
+    labels.resize(static_cast<size_t>(width) * height);
+
+    // Each site links straight to the root of its horizontal run, and a run
+    // joins the cluster above once per stretch of occupied sites above it.
+    // Parents always have smaller indices, so the roots are the cluster minima.
+    auto joinAbove = [&](int site, int x) {
+        return occupied[site - width] && (x == 0 || !occupied[site - width - 1] || !occupied[site - 1]);
+    };
+
+    // Strips on their own; nothing crosses a seam, so the threads touch disjoint sites
+    forStrips(height, strips, [&](unsigned, int first, int end) {
+        for (int y = first; y < end; ++y) {
+            int root = -1;
+            for (int x = 0, site = y * width; x < width; ++x, ++site) {
+                if (!occupied[site]) {
+                    root = -1;
+                    continue;
+                }
+                if (root < 0) root = site;
+                uf.link(site, root);
+                if (y > first && joinAbove(site, x)) root = uf.uniteExclusive(root, site - width);
+            }
+        }
+    });
+
+    // The first row of every strip joins the last row of the strip above; these unions may race
+    forStrips(height, strips, [&](unsigned index, int first, int end) {
+        if (index == 0 || first == end) return;
+        for (int x = 0, site = first * width; x < width; ++x, ++site) {
+            if (occupied[site] && joinAbove(site, x)) uf.unite(site, site - width);
+        }
+    });
+
+    // Parents come before their children, so within a strip the label of a
+    // parent is already known; only links into earlier strips need a find
+    forStrips(height, strips, [&](unsigned, int first, int end) {
+        int begin = first * width;
+        for (int site = begin; site < end * width; ++site) {
+            if (!occupied[site]) {
+                labels[site] = -1;
+                continue;
+            }
+            int up = uf.parentOf(site);
+            labels[site] = up == site ? site : up >= begin ? labels[up] : uf.find(site);
+        }
+    });
+}
+
+void randomLattice(int width, int height, double p, std::uint64_t seed,
+                   std::vector<std::uint8_t>& occupied, unsigned threads) {
+    // A site is occupied when 32 random bits are below p * 2^32
+    const std::uint64_t threshold = static_cast<std::uint64_t>(std::max(0.0, std::min(1.0, p)) * 4294967296.0);
+    occupied.resize(static_cast<size_t>(width) * height);
+
+    forStrips(height, threadCount(threads, height), [&](unsigned, int first, int end) {
+        for (int y = first; y < end; ++y) {
+            PhiloxStream random(seed, static_cast<std::uint64_t>(y));
+            std::uint8_t* row = &occupied[static_cast<size_t>(y) * width];
+            for (int x = 0; x < width; ++x) row[x] = random() < threshold;
+        }
+    });
+}
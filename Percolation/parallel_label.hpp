@@ -0,0 +1,22 @@
+#ifndef PARALLEL_LABEL_HPP
+#define PARALLEL_LABEL_HPP
+#include <cstdint>
+#include <vector>
+
+// Cluster labelling of a width x height site lattice (4 neighbours, open
+// boundaries) split into horizontal strips, one per thread.
+//
+// Each thread first labels its own strip, then the seams between strips are
+// merged concurrently through a lock-free union-find, and finally each thread
+// writes the labels of its strip. labels[site] is the smallest site index in
+// the cluster (-1 for empty sites), so the result is the same for any number
+// of threads. width * height must stay below 2^31.
+void labelParallel(const std::vector<std::uint8_t>& occupied, int width, int height,
+                   std::vector<int>& labels, unsigned threads = 0);
+
+// Occupy each site with probability p; row y draws from Philox stream y of seed,
+// so the lattice does not depend on the number of threads generating it
+void randomLattice(int width, int height, double p, std::uint64_t seed,
+                   std::vector<std::uint8_t>& occupied, unsigned threads = 0);
+
+#endif
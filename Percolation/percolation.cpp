@@ -5,31 +5,17 @@
 #include <cstdlib>
 #include <cmath>
 #include <sstream>
-// Union-Find (Disjoint-Set) Structure to manage clusters
-class UnionFind {
-public:
-    std::vector<int> parent, size;
-    int n;
-
-    UnionFind(int n) : n(n), parent(n), size(n, 1) {
-        for (int i = 0; i < n; i++) parent[i] = i;
-    }
-
-    int find(int x) {
-        if (parent[x] != x) parent[x] = find(parent[x]);
-        return parent[x];
-    }
-
-    void unite(int x, int y) {
-        int rootX = find(x);
-        int rootY = find(y);
-        if (rootX != rootY) {
-            if (size[rootX] < size[rootY]) std::swap(rootX, rootY);
-            parent[rootY] = rootX;
-            size[rootX] += size[rootY];
-        }
-    }
-};
+#include <string>
+#include <chrono>
+#include <limits>
+#include <unordered_set>
+#include "hoshen_kopelman.hpp"
+#include "lattice.hpp"
+#include "lattice_renderer.hpp"
+#include "ensemble.hpp"
+#include "newman_ziff.hpp"
+#include "parallel_label.hpp"
+#include "union_find.hpp"
 
 // Ordered color palette
 std::vector<sf::Color> createColorPalette() {
@@ -88,49 +74,256 @@ float handleKeyInput(float p, sf::RectangleShape& sliderBar, sf::CircleShape& sl
     return p;
 }
 
-void updateGrid(float p, int gridSize, std::vector<bool>& occupied, std::vector<sf::Color>& clusterColors, UnionFind& uf, const std::vector<sf::Color>& colorPalette) {
-    // Reset union-find and grid
-    uf = UnionFind(gridSize * gridSize);  // Reset Union-Find for new clusters
-
-    // Reset grid and assign colors from the palette
-    int colorIndex = 0;
-    for (int i = 0; i < gridSize * gridSize; i++) {
-        occupied[i] = ((rand() / (float)RAND_MAX) < p);
-        if (occupied[i]) {
-            clusterColors[i] = colorPalette[colorIndex % colorPalette.size()];
-            colorIndex++;
-        } else {
-            clusterColors[i] = sf::Color::White;
+// Show the lattice of the sweep at occupation number n. Moving up only adds the
+// sites in between; moving down replays the sweep from the empty lattice.
+void updateGrid(const NewmanZiff& sweep, int n, int& filled, std::vector<bool>& occupied, UnionFind& uf) {
+    if (n < filled) {
+        uf = UnionFind(static_cast<int>(sweep.sites()));
+        std::fill(occupied.begin(), occupied.end(), false);
+        filled = 0;
+    }
+    sweep.replay(filled, n, occupied, uf);
+    filled = n;
+}
+
+// Occupation number of the sweep closest to probability p
+int occupationNumber(const NewmanZiff& sweep, float p) {
+    return static_cast<int>(std::lround(p * sweep.sites()));
+}
+
+// Print what the labeller found
+void printClusterStats(const ClusterStats& stats, double seconds) {
+    double sites = static_cast<double>(stats.width) * stats.height;
+    std::cout << stats.width << "x" << stats.height << " lattice labelled in " << seconds << " s ("
+              << sites / seconds << " sites/s)" << std::endl;
+    std::cout << "  occupied sites: " << stats.occupiedSites << " (" << stats.occupiedSites / sites << ")" << std::endl;
+    std::cout << "  clusters: " << stats.clusterCount << ", largest: " << stats.largestCluster << std::endl;
+    std::cout << "  spanning top-bottom: " << (stats.spansVertically ? "yes" : "no")
+              << ", left-right: " << (stats.spansHorizontally ? "yes" : "no") << std::endl;
+    if (stats.spansVertically) std::cout << "  largest spanning cluster: " << stats.largestSpanning << std::endl;
+}
+
+// Headless Hoshen-Kopelman labelling of a generated lattice (--hk) or of a lattice file (--hk-file)
+int runHoshenKopelman(const std::string& mode, int argc, char* argv[]) {
+    ClusterStats stats;
+    std::string histogramPath;
+    auto start = std::chrono::steady_clock::now();
+
+    if (mode == "--hk") {
+        if (argc < 4) {
+            std::cerr << "Usage: " << argv[0] << " --hk L P [SEED] [HISTOGRAM]" << std::endl;
+            return 1;
+        }
+        int size = std::atoi(argv[2]);
+        double p = std::atof(argv[3]);
+        unsigned long long seed = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : static_cast<unsigned long long>(time(0));
+        if (argc > 5) histogramPath = argv[5];
+        if (size < 1) {
+            std::cerr << "L must be positive" << std::endl;
+            return 1;
+        }
+        std::cout << "Seed " << seed << std::endl;
+        stats = labelRandomLattice(size, size, p, seed);
+    } else {
+        if (argc < 4) {
+            std::cerr << "Usage: " << argv[0] << " --hk-file PATH WIDTH [HISTOGRAM]" << std::endl;
+            return 1;
         }
+        int width = std::atoi(argv[3]);
+        if (argc > 4) histogramPath = argv[4];
+        if (width < 1 || !labelLatticeFile(argv[2], width, stats)) {
+            std::cerr << "Could not read " << argv[2] << " as a lattice " << width << " sites wide" << std::endl;
+            return 1;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printClusterStats(stats, seconds);
+    if (!histogramPath.empty() && !writeHistogram(histogramPath, stats)) {
+        std::cerr << "Could not write " << histogramPath << std::endl;
+        return 1;
     }
+    return 0;
+}
 
-    // Apply percolation rule: Unite adjacent occupied sites
-    for (int y = 0; y < gridSize; y++) {
-        for (int x = 0; x < gridSize; x++) {
-            int index = y * gridSize + x;
-            if (!occupied[index]) continue;
+// Headless Newman-Ziff sweep of an L x L lattice, curves written at POINTS values of p
+int runNewmanZiff(int argc, char* argv[]) {
+    const int POINTS = 201;
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --nz L [SEED] [OUTPUT]" << std::endl;
+        return 1;
+    }
+    int size = std::atoi(argv[2]);
+    unsigned long long seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : static_cast<unsigned long long>(time(0));
+    if (size < 1 || size > NewmanZiff::MAX_SIZE) {
+        std::cerr << "L must be between 1 and " << NewmanZiff::MAX_SIZE << std::endl;
+        return 1;
+    }
 
-            // Check right neighbor
-            if (x + 1 < gridSize && occupied[y * gridSize + (x + 1)])
-                uf.unite(index, y * gridSize + (x + 1));
+    auto start = std::chrono::steady_clock::now();
+    NewmanZiff sweep(size, seed);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Seed " << seed << std::endl;
+    std::cout << size << "x" << size << " sweep over all " << sweep.sites() << " occupation numbers in " << seconds << " s" << std::endl;
+    std::cout << "  spans from n = " << sweep.firstSpanning() << " (p = "
+              << static_cast<double>(sweep.firstSpanning()) / sweep.sites() << ")" << std::endl;
+    if (argc > 4 && !writeSweepCurves(argv[4], sweep.curves(), POINTS)) {
+        std::cerr << "Could not write " << argv[4] << std::endl;
+        return 1;
+    }
+    return 0;
+}
 
-            // Check bottom neighbor
-            if (y + 1 < gridSize && occupied[(y + 1) * gridSize + x])
-                uf.unite(index, (y + 1) * gridSize + x);
+// Headless ensemble of Newman-Ziff sweeps over several lattice sizes, with a finite-size scaling fit
+int runEnsembleMode(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " --ensemble L1,L2,... REALIZATIONS [SEED] [OUTPUT]" << std::endl;
+        return 1;
+    }
+    EnsembleConfig config;
+    std::stringstream sizes(argv[2]);
+    std::string size;
+    while (std::getline(sizes, size, ',')) {
+        int value = std::atoi(size.c_str());
+        if (value < 1 || value > NewmanZiff::MAX_SIZE) {
+            std::cerr << "L must be between 1 and " << NewmanZiff::MAX_SIZE << " (got " << size << ")" << std::endl;
+            return 1;
         }
+        config.sizes.push_back(value);
+    }
+    config.realizations = std::max(1, std::atoi(argv[3]));
+    config.seed = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : static_cast<unsigned long long>(time(0));
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<EnsembleResult> results = runEnsemble(config);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Seed " << config.seed << ", " << config.realizations << " realizations per size in " << seconds << " s" << std::endl;
+    for (const EnsembleResult& result : results) {
+        std::cout << "  L = " << result.size << ": p_c(L) = " << result.threshold.mean << " +- " << result.threshold.error
+                  << ", width " << result.thresholdWidth << std::endl;
     }
+    ScalingFit fit = fitThreshold(results);
+    if (fit.valid) {
+        std::cout << "  p_c(L) = p_c + a L^(-1/nu), nu = " << fit.nu << ": p_c = " << fit.pc << " +- " << fit.pcError << std::endl;
+    }
+    if (fit.widthNu > 0) std::cout << "  nu from the width of the transition: " << fit.widthNu << std::endl;
+
+    if (argc > 5 && !writeEnsembleTable(argv[5], results)) {
+        std::cerr << "Could not write " << argv[5] << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Headless labelling of a generated L x L lattice, split into strips over THREADS threads (0 = all cores)
+int runParallelLabel(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " --label L P [SEED] [THREADS]" << std::endl;
+        return 1;
+    }
+    int size = std::atoi(argv[2]);
+    double p = std::atof(argv[3]);
+    unsigned long long seed = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : static_cast<unsigned long long>(time(0));
+    unsigned threads = argc > 5 ? static_cast<unsigned>(std::atoi(argv[5])) : 0;
+    if (size < 1 || static_cast<long long>(size) * size >= (1LL << 31)) {
+        std::cerr << "L must be between 1 and 46340" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::uint8_t> occupied;
+    std::vector<int> labels;
+    randomLattice(size, size, p, seed, occupied, threads);
+    auto start = std::chrono::steady_clock::now();
+    labelParallel(occupied, size, size, labels, threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Roots label themselves; a cluster spans if a label of the top row shows up in the bottom row
+    long long clusters = 0;
+    for (int site = 0; site < size * size; site++) clusters += labels[site] == site;
+    std::unordered_set<int> top(labels.begin(), labels.begin() + size);
+    bool spans = false;
+    for (int x = 0; x < size && !spans; x++) {
+        int label = labels[(size - 1) * size + x];
+        spans = label >= 0 && top.count(label) > 0;
+    }
+
+    std::cout << "Seed " << seed << std::endl;
+    std::cout << size << "x" << size << " lattice labelled in " << seconds << " s ("
+              << seconds * 1e9 / (static_cast<double>(size) * size) << " ns/site)" << std::endl;
+    std::cout << "  clusters: " << clusters << ", spanning top-bottom: " << (spans ? "yes" : "no") << std::endl;
+    return 0;
+}
+
+// Headless site or bond percolation on another lattice
+int runLattice(int argc, char* argv[]) {
+    std::string kind = argc > 3 ? argv[3] : "";
+    if (argc < 6 || (kind != "site" && kind != "bond")) {
+        std::cerr << "Usage: " << argv[0] << " --lattice square|triangular|honeycomb|cubic site|bond L P [SEED]" << std::endl;
+        return 1;
+    }
+    int size = std::atoi(argv[4]);
+    double p = std::atof(argv[5]);
+    unsigned long long seed = argc > 6 ? std::strtoull(argv[6], nullptr, 10) : static_cast<unsigned long long>(time(0));
+    if (size < 1) {
+        std::cerr << "L must be positive" << std::endl;
+        return 1;
+    }
+
+    long long sites = latticeSites(argv[2], size);
+    if (sites == 0) {
+        std::cerr << "Unknown lattice " << argv[2] << std::endl;
+        return 1;
+    }
+    if (sites > std::numeric_limits<int>::max()) {
+        std::cerr << "L = " << size << " gives " << sites << " sites, more than the labelling can index ("
+                  << std::numeric_limits<int>::max() << ")" << std::endl;
+        return 1;
+    }
+
+    LatticeStats stats;
+    double threshold = 0;
+    auto start = std::chrono::steady_clock::now();
+    percolateLattice(argv[2], kind == "bond", size, p, seed, stats, threshold);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Seed " << seed << std::endl;
+    std::cout << argv[2] << " " << kind << " percolation, L = " << size << ", p = " << p
+              << " (threshold " << threshold << "), " << seconds << " s" << std::endl;
+    std::cout << "  clusters: " << stats.clusters << ", largest: " << stats.largestCluster
+              << ", spanning: " << (stats.spans ? "yes" : "no") << std::endl;
+    return 0;
 }
 
-int main() {
-    // Grid size
-    const int gridSize = 50;  // Number of cells along one axis
-    const int cellSize = 10;  // Pixel size of each cell
-    const int windowSize = gridSize * cellSize;
+int main(int argc, char* argv[]) {
+    // Usage:
+    //   ./percolation [L]                          interactive window (L = 50); wheel zooms, right drag pans, Home resets
+    //   ./percolation --hk L P [SEED] [HISTOGRAM]   label an L x L lattice generated row by row
+    //   ./percolation --hk-file PATH WIDTH [HISTOGRAM]  label a lattice file, one byte per site
+    //   ./percolation --nz L [SEED] [OUTPUT]        Newman-Ziff sweep, curves over p
+    //   ./percolation --ensemble L1,L2,... REALIZATIONS [SEED] [OUTPUT]  threshold estimates on all cores
+    //   ./percolation --label L P [SEED] [THREADS]  parallel labelling of one large lattice
+    //   ./percolation --lattice NAME site|bond L P [SEED]  square, triangular, honeycomb or cubic lattices
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--hk" || mode == "--hk-file") return runHoshenKopelman(mode, argc, argv);
+    if (mode == "--nz") return runNewmanZiff(argc, argv);
+    if (mode == "--ensemble") return runEnsembleMode(argc, argv);
+    if (mode == "--label") return runParallelLabel(argc, argv);
+    if (mode == "--lattice") return runLattice(argc, argv);
+    if (mode.compare(0, 2, "--") == 0) {
+        std::cerr << "Unknown option " << mode << std::endl;
+        return 1;
+    }
+
+    // Grid size, 50 unless given as ./percolation L
+    const int gridSize = std::max(1, std::min(argc > 1 ? std::atoi(argv[1]) : 50, static_cast<int>(sf::Texture::getMaximumSize())));
+    const int windowSize = 500;  // Pixels along each side of the lattice area
     const int sliderHeight = 40;  // Height of slider area
     float p = 1.0;  // Initial probability of site occupation (p=1)
 
-    // Initialize random seed
-    srand(static_cast<unsigned>(time(0)));
+    // One sweep through all occupation numbers; the slider only picks one of them
+    NewmanZiff sweep(gridSize, static_cast<unsigned long long>(time(0)));
 
     // Create SFML window
     sf::RenderWindow window(sf::VideoMode(windowSize, windowSize + sliderHeight), "Percolation Simulation with Ordered Color Palette");
@@ -150,12 +343,32 @@ int main() {
     UnionFind uf(gridSize * gridSize);  // Union-Find to track clusters
     std::vector<bool> occupied(gridSize * gridSize, false);  // Grid state
     std::vector<sf::Color> clusterColors(gridSize * gridSize, sf::Color::White);  // Colors for each cluster
+    int filled = 0;  // Occupation number held by occupied and uf
 
-    // Ordered color palette
+    // Ordered color palette, assigned to the sites in the order the sweep occupies them
     std::vector<sf::Color> colorPalette = createColorPalette();
+    for (int n = 0; n < sweep.sites(); n++) clusterColors[sweep.site(n)] = colorPalette[n % colorPalette.size()];
+
+    // The lattice is one texture, recolored only when the grid changes
+    LatticeRenderer renderer(gridSize, windowSize, window.getSize());
 
     // Initial grid generation
-    updateGrid(p, gridSize, occupied, clusterColors, uf, colorPalette);
+    updateGrid(sweep, occupationNumber(sweep, p), filled, occupied, uf);
+    renderer.update(occupied, uf, clusterColors);
+
+    // Text, with the font loaded once
+    sf::Font font;
+    if (!font.loadFromFile("/usr/share/fonts/truetype/msttcorefonts/ariali.ttf")) {
+        return -1;
+    }
+    sf::Text p_Text;
+    p_Text.setFont(font);
+    p_Text.setCharacterSize(24);
+    p_Text.setFillColor(sf::Color::Black);
+    p_Text.setPosition(10.f, 10.f);
+
+    bool dragging = false;  // Right mouse button held on the lattice
+    sf::Vector2i dragFrom;
 
     while (window.isOpen()) {
         // Handle events
@@ -163,6 +376,23 @@ int main() {
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed || sf::Keyboard::isKeyPressed(sf::Keyboard::Escape))
                 window.close();
+
+            // Zoom and pan the lattice
+            if (event.type == sf::Event::MouseWheelScrolled) {
+                sf::Vector2i pixel(event.mouseWheelScroll.x, event.mouseWheelScroll.y);
+                if (renderer.contains(pixel)) renderer.zoom(event.mouseWheelScroll.delta > 0 ? 0.8f : 1.25f, pixel, window);
+            } else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Right) {
+                dragFrom = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+                dragging = renderer.contains(dragFrom);
+            } else if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Right) {
+                dragging = false;
+            } else if (event.type == sf::Event::MouseMoved && dragging) {
+                sf::Vector2i dragTo(event.mouseMove.x, event.mouseMove.y);
+                renderer.drag(dragFrom, dragTo, window);
+                dragFrom = dragTo;
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Home) {
+                renderer.reset();
+            }
         }
 
         // Update p based on slider position or key press
@@ -172,46 +402,15 @@ int main() {
         // If p changes, update the grid
         if (newP != p) {
             p = newP;
-            updateGrid(p, gridSize, occupied, clusterColors, uf, colorPalette);  // Update the grid only when `p` changes
+            updateGrid(sweep, occupationNumber(sweep, p), filled, occupied, uf);  // Update the grid only when `p` changes
+            renderer.update(occupied, uf, clusterColors);
         }
 
         // Draw the grid and slider
         window.clear();
 
         // Draw the grid
-        for (int y = 0; y < gridSize; y++) {
-            for (int x = 0; x < gridSize; x++) {
-                int index = y * gridSize + x;
-
-                sf::RectangleShape cell(sf::Vector2f(cellSize, cellSize));
-                cell.setPosition(x * cellSize, y * cellSize);
-
-                if (occupied[index]) {
-                    // Assign color based on cluster root
-                    int root = uf.find(index);
-                    cell.setFillColor(clusterColors[root]);
-                } else {
-                    cell.setFillColor(sf::Color::White);
-                }
-
-                cell.setOutlineThickness(1);
-                cell.setOutlineColor(sf::Color::Black);
-                window.draw(cell);
-            }
-        }
-
-        //Text
-            sf::Font font;
-        if (!font.loadFromFile("/usr/share/fonts/truetype/msttcorefonts/ariali.ttf")) {
-            return -1;
-        }
-
-        // Create the text
-        sf::Text p_Text;
-        p_Text.setFont(font);
-        p_Text.setCharacterSize(24);
-        p_Text.setFillColor(sf::Color::Black);
-        p_Text.setPosition(10.f, 10.f);
+        renderer.draw(window);
 
         // Draw the slider
         window.draw(sliderBar);
@@ -219,7 +418,11 @@ int main() {
 
         // Draw p value of slider.
         std::stringstream ss;
+        int n = occupationNumber(sweep, p);
         ss << "p = " << (round(p*100))/100 << std::endl;
+        ss << "spanning: " << (sweep.curves().spanning[n] > 0 ? "yes" : "no")
+           << "  largest: " << sweep.curves().largestCluster[n]
+           << "  mean size: " << (round(sweep.curves().meanClusterSize[n]*10))/10 << std::endl;
         p_Text.setString(ss.str());
         window.draw(p_Text);
         window.display();
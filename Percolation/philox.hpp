@@ -0,0 +1,81 @@
+#ifndef PHILOX_HPP
+#define PHILOX_HPP
+#include <array>
+#include <cstdint>
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random
+// numbers: as easy as 1, 2, 3", SC11). The output is a fixed function of a
+// 128-bit counter and a 64-bit key, with no state carried between calls, so
+// any number of threads can draw independent streams just by using different
+// counters: no sharing, no locking and the same numbers whatever the thread count.
+namespace philox {
+
+    typedef std::array<std::uint32_t, 4> Counter;
+    typedef std::array<std::uint32_t, 2> Key;
+
+    inline Counter block(Counter counter, Key key) {
+        const std::uint32_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u;
+        const std::uint32_t W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+        for (int round = 0; round < 10; ++round) {
+            std::uint64_t product0 = static_cast<std::uint64_t>(M0) * counter[0];
+            std::uint64_t product1 = static_cast<std::uint64_t>(M1) * counter[2];
+            counter = {static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                       static_cast<std::uint32_t>(product1),
+                       static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                       static_cast<std::uint32_t>(product0)};
+            key[0] += W0;
+            key[1] += W1;
+        }
+        return counter;
+    }
+}
+
+// Sequential numbers from one Philox stream: the counter is (position in the
+// stream, stream) and the key is the seed. Streams with different numbers are
+// independent, so e.g. realization r of an ensemble can use stream r on any thread.
+class PhiloxStream {
+public:
+    typedef std::uint32_t result_type;
+
+    PhiloxStream(std::uint64_t seed, std::uint64_t stream)
+        : key{{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)}},
+          stream(stream) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+    result_type operator()() {
+        if (used == 4) {
+            buffer = philox::block({{static_cast<std::uint32_t>(position), static_cast<std::uint32_t>(position >> 32),
+                                     static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32)}},
+                                   key);
+            ++position;
+            used = 0;
+        }
+        return buffer[used++];
+    }
+
+    // Uniform in [0, bound) without modulo bias (Lemire's multiply and reject).
+    // Unlike std::uniform_int_distribution it gives the same numbers with every standard library.
+    std::uint32_t below(std::uint32_t bound) {
+        std::uint64_t product = static_cast<std::uint64_t>((*this)()) * bound;
+        std::uint32_t low = static_cast<std::uint32_t>(product);
+        if (low < bound) {
+            std::uint32_t threshold = static_cast<std::uint32_t>(-bound) % bound;
+            while (low < threshold) {
+                product = static_cast<std::uint64_t>((*this)()) * bound;
+                low = static_cast<std::uint32_t>(product);
+            }
+        }
+        return static_cast<std::uint32_t>(product >> 32);
+    }
+
+private:
+    philox::Key key;
+    std::uint64_t stream;
+    std::uint64_t position = 0;
+    philox::Counter buffer{};
+    int used = 4;
+};
+
+#endif
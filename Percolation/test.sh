@@ -0,0 +1,3 @@
+#!/bin/bash
+
+g++ -O2 -o random_rows_test tests/random_rows_test.cpp hoshen_kopelman.cpp && ./random_rows_test
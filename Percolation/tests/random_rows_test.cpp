@@ -0,0 +1,52 @@
+// Checks of the random rows of labelRandomLattice. Build and run with ./test.sh
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+#include "../hoshen_kopelman.hpp"
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool ok, const char* what, std::uint64_t seed) {
+        if (ok) return;
+        std::printf("FAILED: %s (seed %llu)\n", what, static_cast<unsigned long long>(seed));
+        ++failures;
+    }
+
+    // True if row b is row a shifted by some -8..8 sites (over their overlap)
+    bool shiftedCopy(const std::vector<std::uint8_t>& a, const std::vector<std::uint8_t>& b) {
+        int width = static_cast<int>(a.size());
+        for (int shift = -8; shift <= 8; ++shift) {
+            bool same = true;
+            for (int x = 8; x < width - 8 && same; ++x) same = a[x] == b[x + shift];
+            if (same) return true;
+        }
+        return false;
+    }
+}
+
+int main() {
+    const std::uint64_t seeds[] = {0, 1ull << 63, 1, 12345};
+    const int width = 256;
+
+    for (std::uint64_t seed : seeds) {
+        // Adjacent rows must not be copies of each other, whatever the seed
+        std::vector<std::uint8_t> previous(width), current(width);
+        randomRow(width, 0.5, seed, 0, previous.data());
+        int copies = 0;
+        for (long long y = 1; y < 1000; ++y) {
+            randomRow(width, 0.5, seed, y, current.data());
+            copies += shiftedCopy(previous, current);
+            previous.swap(current);
+        }
+        check(copies == 0, "adjacent rows are shifted copies", seed);
+
+        // Well below p_c = 0.5927 the largest cluster of 256^2 sites is about 100
+        ClusterStats stats = labelRandomLattice(width, width, 0.40, seed);
+        check(stats.largestCluster < 300, "largest cluster at p = 0.40 is too large", seed);
+    }
+
+    if (failures == 0) std::printf("random rows: all checks passed\n");
+    return failures == 0 ? 0 : 1;
+}
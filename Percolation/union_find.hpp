@@ -0,0 +1,136 @@
+#ifndef UNION_FIND_HPP
+#define UNION_FIND_HPP
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Union-Find (Disjoint-Set) Structure to manage clusters
+//
+// One Index per element: a root stores minus the size of its set, any other
+// element the index of its parent, so int indices cost 4 bytes per site.
+// find() is iterative with path halving, which keeps the trees flat without
+// recursion, so even a lattice filled by one huge cluster can not overflow
+// the stack. Index = std::int64_t takes lattices beyond 2^31 sites.
+template <typename Index>
+class CompactUnionFind {
+public:
+    CompactUnionFind(Index n = 0) : parent(n, -1) {}
+
+    Index count() const { return static_cast<Index>(parent.size()); }
+
+    Index find(Index x) {
+        // Path halving: every other node on the way points to its grandparent
+        while (parent[x] >= 0) {
+            Index up = parent[x];
+            if (parent[up] < 0) return up;
+            parent[x] = parent[up];
+            x = parent[up];
+        }
+        return x;
+    }
+
+    // Merge the sets of x and y (the smaller under the larger) and return the root of the result
+    Index unite(Index x, Index y) {
+        Index rootX = find(x);
+        Index rootY = find(y);
+        if (rootX != rootY) {
+            if (parent[rootX] > parent[rootY]) std::swap(rootX, rootY); // Sizes are negated
+            parent[rootX] += parent[rootY];
+            parent[rootY] = rootX;
+        }
+        return rootX;
+    }
+
+    bool isRoot(Index x) const { return parent[x] < 0; }
+
+    // Size of the set of x
+    Index setSize(Index x) { return -parent[find(x)]; }
+
+private:
+    std::vector<Index> parent;
+};
+
+typedef CompactUnionFind<int> UnionFind;
+
+// Union-find that threads can update at the same time without locks.
+//
+// Roots point to themselves. unite() links the root with the larger index
+// under the one with the smaller index by compare-and-swap, retrying if
+// another thread changed that root first, so the root of every set is its
+// smallest element whatever the order of the unions. find() halves paths
+// with compare-and-swap as well; a lost race only leaves a longer path.
+// There are no sizes (keeping them exact would need a second CAS per link).
+template <typename Index>
+class ConcurrentUnionFind {
+public:
+    // With initialize = false the memory is left untouched (so the threads
+    // that use it can fault it in themselves, each on its own part), and every
+    // element must be made a root with link(x, x) before it is used
+    explicit ConcurrentUnionFind(Index n, bool initialize = true) : elements(n), parent(new std::atomic<Index>[n]) {
+        if (initialize) {
+            for (Index i = 0; i < n; ++i) parent[i].store(i, std::memory_order_relaxed);
+        }
+    }
+
+    Index count() const { return elements; }
+
+    Index find(Index x) {
+        while (true) {
+            Index up = parent[x].load(std::memory_order_relaxed);
+            if (up == x) return x;
+            Index upper = parent[up].load(std::memory_order_relaxed);
+            if (upper != up) parent[x].compare_exchange_weak(up, upper, std::memory_order_relaxed);
+            x = upper;
+        }
+    }
+
+    // Merge the sets of x and y and return the root of the result
+    Index unite(Index x, Index y) {
+        while (true) {
+            x = find(x);
+            y = find(y);
+            if (x == y) return x;
+            if (x < y) std::swap(x, y);
+            Index expected = x;
+            if (parent[x].compare_exchange_strong(expected, y, std::memory_order_acq_rel)) return y;
+        }
+    }
+
+    // find() and unite() for sets no other thread touches at the time, such as
+    // the clusters inside one thread's part of a lattice: plain loads and
+    // stores where the shared versions need compare-and-swap
+    Index findExclusive(Index x) {
+        while (true) {
+            Index up = parent[x].load(std::memory_order_relaxed);
+            if (up == x) return x;
+            Index upper = parent[up].load(std::memory_order_relaxed);
+            if (upper == up) return up;
+            parent[x].store(upper, std::memory_order_relaxed);
+            x = upper;
+        }
+    }
+
+    Index uniteExclusive(Index x, Index y) {
+        x = findExclusive(x);
+        y = findExclusive(y);
+        if (x < y) std::swap(x, y);
+        parent[x].store(y, std::memory_order_relaxed);
+        return y;
+    }
+
+    bool isRoot(Index x) const { return parent[x].load(std::memory_order_relaxed) == x; }
+
+    Index parentOf(Index x) const { return parent[x].load(std::memory_order_relaxed); }
+
+    // Attach the single element x to root, which must be in a set of smaller
+    // indices (or be x itself); cheaper than unite() when no other thread can touch x yet
+    void link(Index x, Index root) { parent[x].store(root, std::memory_order_relaxed); }
+
+private:
+    Index elements;
+    std::unique_ptr<std::atomic<Index>[]> parent;
+};
+
+#endif